@@ -31,8 +31,8 @@ void stopLocomotives(unsigned char train)
     reply.msgAddr->arg1 = train;
     reply.msgAddr->arg2 = STOP;
 
-    /* Send request to data link layer */
-    sendMessage(APPDATALINKMB, DATALINKAPPMB, reply.recvAddr, msgSize);
+    /* Send request to data link layer ahead of any queued routine requests */
+    sendPriorityMessage(APPDATALINKMB, DATALINKAPPMB, reply.recvAddr, msgSize, MSG_PRIORITY_URGENT);
 
     return;
 }
@@ -63,6 +63,9 @@ void AppfromDataLinkHandler(void)
     /* Ensure bind was successful */
     if(Mailbox == SUCCESS)
     {
+        /* Hall sensor events are published rather than sent to this mailbox */
+        subscribe(HALL_SENSOR_TOPIC, DATALINKAPPMB);
+
         /* Loop indefinitely while processing message received from data link layer */
         while(1)
         {
@@ -75,6 +78,7 @@ void AppfromDataLinkHandler(void)
                 /* Hall sensor has been triggered */
                 case HALL_TRIGGERED:
                 //TODO: Need to check state of each train to determine which train triggered this hall sensor
+                mutexLock(TRAIN_STATE_MUTEX);
                 path = getPath(received.msgAddr->arg1, TState.destination);
 
                 /* Check whether train must be stopped */
@@ -122,6 +126,7 @@ void AppfromDataLinkHandler(void)
                         }
                     }
                 }
+                mutexUnlock(TRAIN_STATE_MUTEX);
 
                 /* Must also send acknowledgment message */
                 reply.msgAddr->code = HALL_TRIGGERED_ACK;
@@ -214,6 +219,12 @@ void AppfromUART0Handler(void)
             recvSize = MESSAGE_SYS_LIMIT;
             recvMessage(UART0APPMB, &senderMB, received, &recvSize);
             end = *received - '0';
+
+            /* Follow the requests this route produces down to UART1 */
+            startCorrelation();
+
+            /* Train state is shared with the data link message handler */
+            mutexLock(TRAIN_STATE_MUTEX);
             TState.destination = end;
             path = getPath(start, end);
 
@@ -266,6 +277,8 @@ void AppfromUART0Handler(void)
                     }
                 }
             }
+            mutexUnlock(TRAIN_STATE_MUTEX);
+            endCorrelation();
         }
     }
 
@@ -13,6 +13,11 @@
 #define UART0APPMB    (10)
 #define DATALINKAPPMB (11)
 
+/* Define topic hall sensor events are published to; any process may
+ * subscribe a mailbox to it alongside the application layer
+ */
+#define HALL_SENSOR_TOPIC (0)
+
 /* Define all indicator for messages sent from application layer */
 #define ALL           (0xFF)
 
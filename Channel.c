@@ -0,0 +1,250 @@
+/*
+ * @file    Channel.c
+ * @brief   Contains the kernel side of ring channels (open, sleep and
+ *          wake) and the lock-free put and get used by the two processes
+ *          sharing a channel
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#include <string.h>
+#include "SVC.h"
+#include "KernelCall.h"
+#define GLOBAL_CHANNEL
+#include "Channel.h"
+#include "Correlation.h"
+
+/*Channels, unused until opened*/
+static Channel channelList[CHANNEL_AMOUNT];
+
+/*
+ * @brief   Validates a channel id and side
+ * @param   [in] int id: index of the channel
+ *          [in] int side: CHANNEL_CONSUMER or CHANNEL_PRODUCER
+ * @return  Channel *: the opened channel, NULL if invalid
+ */
+Channel * getChannel(int id, int side)
+{
+    if(!(0 <= id && id < CHANNEL_AMOUNT) ||
+       ((side != CHANNEL_CONSUMER) && (side != CHANNEL_PRODUCER)) ||
+       !(channelList[id].slots))
+    {return NULL;}
+
+    return &channelList[id];
+}
+
+/*
+ * @brief   Opens a channel, allocating its ring on first use. Both the
+ *          producer and the consumer open the channel with the same
+ *          element size and depth and are handed the same ring.
+ * @param   [in] int id: index of the channel
+ *          [in] int elemSize: most bytes of data an element holds
+ *          [in] int depth: number of slots, a power of two
+ * @return  Channel *: address of the ring, NULL if the request is invalid
+ *          or does not match the channel's existing ring
+ */
+Channel * kernelChannelOpen(int id, int elemSize, int depth)
+{
+    Channel * ch;
+
+    if(!(0 <= id && id < CHANNEL_AMOUNT) || (elemSize <= 0) ||
+       (depth <= 0) || (depth > CHANNEL_MAX_DEPTH) || (depth & (depth - 1)))
+    {return NULL;}
+
+    ch = &channelList[id];
+
+    if(ch->slots)
+    {
+        return ((ch->elemSize == elemSize) && (ch->depth == (unsigned int)depth))? ch : NULL;
+    }
+
+    // Keep every slot word aligned
+    ch->stride = (sizeof(int) + elemSize + sizeof(int) - 1) & ~(sizeof(int) - 1);
+    ch->slots = malloc(depth * ch->stride);
+    if(!ch->slots)
+    {return NULL;}
+
+    ch->id = id;
+    ch->elemSize = elemSize;
+    ch->depth = depth;
+    ch->head = ch->tail = 0;
+    ch->waiting[CHANNEL_CONSUMER] = ch->waiting[CHANNEL_PRODUCER] = FALSE;
+    ch->waiter[CHANNEL_CONSUMER] = ch->waiter[CHANNEL_PRODUCER] = NULL;
+    return ch;
+}
+
+/*
+ * @brief   Puts the running process to sleep until its side of a channel
+ *          can make progress. The ring is checked again after the waiting
+ *          flag is raised, so an element put or taken just before the
+ *          flag was seen is never missed.
+ * @param   [in] int id: index of the channel
+ *          [in] int side: CHANNEL_CONSUMER to wait for an element,
+ *                         CHANNEL_PRODUCER to wait for a free slot
+ * @return  int: 1->success, -1->invalid channel
+ */
+int kernelChannelWait(int id, int side)
+{
+    PCB * runningPCB;
+    Channel * ch = getChannel(id, side);
+
+    if(!ch)
+    {return FAILURE;}
+
+    ch->waiting[side] = TRUE;
+
+    if((side == CHANNEL_CONSUMER)? !CHANNEL_EMPTY(ch) : !CHANNEL_FULL(ch))
+    {
+        ch->waiting[side] = FALSE;
+        return SUCCESS;
+    }
+
+    // BLOCK until the other side signals
+    runningPCB = blockPCB(CHANNEL_BLOCKED);
+    ch->waiter[side] = runningPCB;
+    return SUCCESS;
+}
+
+/*
+ * @brief   Wakes the process sleeping on one side of a channel
+ * @param   [in] int id: index of the channel
+ *          [in] int side: side being woken
+ * @return  int: 1->success, -1->invalid channel
+ */
+int kernelChannelSignal(int id, int side)
+{
+    PCB * waiter;
+    Channel * ch = getChannel(id, side);
+
+    if(!ch)
+    {return FAILURE;}
+
+    ch->waiting[side] = FALSE;
+    waiter = ch->waiter[side];
+
+    if(waiter)
+    {
+        ch->waiter[side] = NULL;
+        waiter->blockState = READY;
+        addPCB(waiter, waiter->priority);
+    }
+    return SUCCESS;
+}
+
+/*
+ * @brief   Copies an element into the ring without entering the kernel,
+ *          unless the consumer is asleep and must be woken
+ * @param   [in/out] Channel * ch: channel written by the running process
+ *          [in] void * data: element to copy
+ *          [in] int size: bytes in the element
+ * @return  int: TRUE if the element was put, FALSE if the ring is full
+ *          or the element does not fit a slot
+ */
+int channelPut(Channel * ch, void * data, int size)
+{
+    char * slot;
+    PCB * running;
+    unsigned long mask;
+
+    if((size <= 0) || (size > ch->elemSize) || CHANNEL_FULL(ch))
+    {return FALSE;}
+
+    slot = CHANNEL_SLOT(ch, ch->head);
+    *((int *)slot) = size;
+    memcpy(slot + sizeof(int), data, size);
+
+    /* The slot carries the producer's correlation; the PCB is kernel
+     * state, so it is only read with the kernel held off
+     */
+    mask = get_PRIMASK();
+    disable();
+    running = getRunningPCB();
+    ch->correlation[ch->head & (ch->depth - 1)] = running->correlation;
+    ch->correlationStamp[ch->head & (ch->depth - 1)] = running->correlationStamp;
+    set_PRIMASK(mask);
+
+    CHANNEL_BARRIER();
+    ch->head++;
+
+    if(ch->waiting[CHANNEL_CONSUMER])
+    {
+        channelSignal(ch->id, CHANNEL_CONSUMER);
+    }
+    return TRUE;
+}
+
+/*
+ * @brief   Copies the oldest element out of the ring without entering the
+ *          kernel, unless the producer is asleep and must be woken
+ * @param   [in/out] Channel * ch: channel read by the running process
+ *          [out] void * data: where the element is copied, at least the
+ *                             channel's element size
+ * @return  int: bytes in the element, 0 if the ring is empty
+ */
+int channelGet(Channel * ch, void * data)
+{
+    char * slot;
+    int size;
+    unsigned long mask;
+
+    if(CHANNEL_EMPTY(ch))
+    {return EMPTY;}
+
+    slot = CHANNEL_SLOT(ch, ch->tail);
+    size = *((int *)slot);
+    memcpy(data, slot + sizeof(int), size);
+
+    /* Adopting the correlation updates the PCB and the kernel's hop
+     * histograms, so SysTick and the kernel are held off meanwhile
+     */
+    mask = get_PRIMASK();
+    disable();
+    adoptCorrelation(getRunningPCB(), ch->correlation[ch->tail & (ch->depth - 1)],
+                     ch->correlationStamp[ch->tail & (ch->depth - 1)], CHANNEL_HOP(ch->id));
+    set_PRIMASK(mask);
+
+    CHANNEL_BARRIER();
+    ch->tail++;
+
+    if(ch->waiting[CHANNEL_PRODUCER])
+    {
+        channelSignal(ch->id, CHANNEL_PRODUCER);
+    }
+    return size;
+}
+
+/*
+ * @brief   Puts an element, sleeping while the ring is full
+ * @param   [in/out] Channel * ch: channel written by the running process
+ *          [in] void * data: element to copy
+ *          [in] int size: bytes in the element
+ * @return  int: 1->success, -1->element does not fit a slot
+ */
+int channelSend(Channel * ch, void * data, int size)
+{
+    if((size <= 0) || (size > ch->elemSize))
+    {return FAILURE;}
+
+    while(!channelPut(ch, data, size))
+    {
+        channelWait(ch->id, CHANNEL_PRODUCER);
+    }
+    return SUCCESS;
+}
+
+/*
+ * @brief   Gets an element, sleeping while the ring is empty
+ * @param   [in/out] Channel * ch: channel read by the running process
+ *          [out] void * data: where the element is copied
+ * @return  int: bytes in the element
+ */
+int channelReceive(Channel * ch, void * data)
+{
+    int size;
+
+    while(!(size = channelGet(ch, data)))
+    {
+        channelWait(ch->id, CHANNEL_CONSUMER);
+    }
+    return size;
+}
@@ -0,0 +1,71 @@
+/*
+ * @file    Channel.h
+ * @brief   Single producer, single consumer ring channels shared between
+ *          two processes. Slots are written and read without kernel calls;
+ *          the kernel is only entered to sleep on an empty or full ring and
+ *          to wake the other side. The correlation each slot carries is
+ *          read from and adopted into kernel state with interrupts masked.
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#pragma once
+#include "Process.h"
+#include "Utilities.h"
+
+/* Number of channels and largest ring allowed */
+#define CHANNEL_AMOUNT      4
+#define CHANNEL_MAX_DEPTH   16
+
+/* Orders slot contents before the index update that publishes them */
+#define CHANNEL_BARRIER()   __asm(" dmb")
+
+/* Side of a channel a process waits on or wakes */
+enum channelSides {CHANNEL_CONSUMER, CHANNEL_PRODUCER};
+
+/* Structure of a ring channel; each slot is an int size followed by data */
+typedef struct Channel_
+{
+    int id;
+    /* Most bytes of data a slot holds */
+    int elemSize;
+    /* Bytes between slots */
+    int stride;
+    /* Number of slots, a power of two */
+    unsigned int depth;
+    /* Free running slot counters, head written only by the producer
+     * and tail only by the consumer
+     */
+    volatile unsigned int head;
+    volatile unsigned int tail;
+    /* Set by a side about to sleep so the other side knows to wake it */
+    volatile int waiting[2];
+    /* PCB of each side while it sleeps */
+    struct ProcessControlBlock_ * waiter[2];
+    char * slots;
+    /* Correlation carried by each slot, see Correlation.h */
+    unsigned int correlation[CHANNEL_MAX_DEPTH];
+    unsigned long correlationStamp[CHANNEL_MAX_DEPTH];
+
+}Channel;
+
+#define CHANNEL_SLOT(ch, count)  ((ch)->slots + (((count) & ((ch)->depth - 1)) * (ch)->stride))
+#define CHANNEL_EMPTY(ch)        ((ch)->head == (ch)->tail)
+#define CHANNEL_FULL(ch)         (((ch)->head - (ch)->tail) == (ch)->depth)
+
+#ifndef GLOBAL_CHANNEL
+#define GLOBAL_CHANNEL
+
+extern Channel * kernelChannelOpen(int, int, int);
+extern int kernelChannelWait(int, int);
+extern int kernelChannelSignal(int, int);
+extern int channelPut(Channel *, void *, int);
+extern int channelGet(Channel *, void *);
+extern int channelSend(Channel *, void *, int);
+extern int channelReceive(Channel *, void *);
+
+#else
+
+Channel * getChannel(int, int);
+
+#endif /* GLOBAL_CHANNEL */
@@ -0,0 +1,84 @@
+/*
+ * @file    Clock.c
+ * @brief   Contains the system clock set up. The main oscillator is
+ *          started, the PLL locked and the flash timing raised before the
+ *          system clock is switched over. Should the crystal or the PLL
+ *          fail to come up the part stays on the internal oscillator.
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#define GLOBAL_CLOCK
+#include "Clock.h"
+#include "Utilities.h"
+
+/* Rate the system clock is running at */
+static unsigned long systemClock = CLOCK_PIOSC_HZ;
+
+/*
+ * @brief   Polls a status register until any of the given bits are set
+ * @param   [in] volatile unsigned long* reg: status register
+ *          [in] unsigned long bits: bits waited for
+ * @return  int: TRUE if they were set within CLOCK_STARTUP_POLLS reads
+ */
+static int waitForStatus(volatile unsigned long * reg, unsigned long bits)
+{
+    unsigned long polls;
+
+    for(polls = 0; polls < CLOCK_STARTUP_POLLS; polls++)
+    {
+        if(REG_READ(reg) & bits)
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/*
+ * @brief   Runs the system clock from the PLL at CLOCK_PLL_HZ. Must be
+ *          called before any peripheral whose timing depends on it is set up.
+ */
+void Clock_Init(void)
+{
+    /* Power up the main oscillator for a crystal above 10 MHz */
+    REG_CLEAR(SYSCTL_MOSCCTL_R, SYSCTL_MOSCCTL_NOXTAL | SYSCTL_MOSCCTL_PWRDN);
+    REG_SET(SYSCTL_MOSCCTL_R, SYSCTL_MOSCCTL_OSCRNG);
+    if(!waitForStatus(SYSCTL_RIS_R, SYSCTL_RIS_MOSCPUPRIS))
+    {
+        return;
+    }
+
+    /* Feed the PLL from the main oscillator and set the VCO to 480 MHz */
+    REG_WRITE(SYSCTL_RSCLKCFG_R, (REG_READ(SYSCTL_RSCLKCFG_R) & ~SYSCTL_RSCLKCFG_SRC_M)
+                                 | SYSCTL_RSCLKCFG_SRC_MOSC);
+    REG_CLEAR(SYSCTL_PLLFREQ0_R, SYSCTL_PLLFREQ0_PLLPWR);
+    REG_WRITE(SYSCTL_PLLFREQ1_R, CLOCK_PLL_N);
+    REG_WRITE(SYSCTL_PLLFREQ0_R, (REG_READ(SYSCTL_PLLFREQ0_R) & ~SYSCTL_PLLFREQ0_M)
+                                 | CLOCK_PLL_MINT);
+    REG_SET(SYSCTL_PLLFREQ0_R, SYSCTL_PLLFREQ0_PLLPWR);
+    REG_SET(SYSCTL_RSCLKCFG_R, SYSCTL_RSCLKCFG_NEWFREQ);
+
+    /* Flash and EEPROM timing for the new rate, applied on the switch */
+    REG_WRITE(SYSCTL_MEMTIM0_R, (REG_READ(SYSCTL_MEMTIM0_R) & ~SYSCTL_MEMTIM0_M)
+                                | CLOCK_MEMTIM0_120MHZ);
+    if(!waitForStatus(SYSCTL_PLLSTAT_R, SYSCTL_PLLSTAT_LOCK))
+    {
+        return;
+    }
+
+    REG_WRITE(SYSCTL_RSCLKCFG_R, (REG_READ(SYSCTL_RSCLKCFG_R) & ~SYSCTL_RSCLKCFG_PSYSDIV_M)
+                                 | SYSCTL_RSCLKCFG_MEMTIMU | SYSCTL_RSCLKCFG_USEPLL
+                                 | CLOCK_PLL_PSYSDIV);
+    systemClock = CLOCK_PLL_HZ;
+}
+
+/*
+ * @brief   Rate of the system clock, which also clocks the UARTs and SysTick
+ * @return  unsigned long: system clock in Hz
+ */
+unsigned long getSystemClock(void)
+{
+    return systemClock;
+}
@@ -0,0 +1,58 @@
+/*
+ * @file    Clock.h
+ * @brief   System clock configuration. Brings the TM4C1294 up from the
+ *          16 MHz internal oscillator to 120 MHz from the PLL, driven by
+ *          the 25 MHz main crystal, and reports the rate actually running
+ *          so baud divisors and the SysTick period can be computed.
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#pragma once
+#include "Registers.h"
+
+#define SYSCTL_RIS_R        REGISTER(0x400FE050)    // Raw Interrupt Status
+#define SYSCTL_MOSCCTL_R    REGISTER(0x400FE07C)    // Main Oscillator Control
+#define SYSCTL_RSCLKCFG_R   REGISTER(0x400FE0B0)    // Run and Sleep Mode Clock Configuration
+#define SYSCTL_MEMTIM0_R    REGISTER(0x400FE0C0)    // Memory Timing Parameter Register 0
+#define SYSCTL_PLLFREQ0_R   REGISTER(0x400FE160)    // PLL Frequency 0
+#define SYSCTL_PLLFREQ1_R   REGISTER(0x400FE164)    // PLL Frequency 1
+#define SYSCTL_PLLSTAT_R    REGISTER(0x400FE168)    // PLL Status
+
+#define SYSCTL_RIS_MOSCPUPRIS       0x00000100  // MOSC Power Up Raw Interrupt Status
+#define SYSCTL_MOSCCTL_OSCRNG       0x00000010  // Oscillator Range: high (> 10 MHz)
+#define SYSCTL_MOSCCTL_PWRDN        0x00000008  // Power Down
+#define SYSCTL_MOSCCTL_NOXTAL       0x00000004  // No Crystal Connected
+#define SYSCTL_RSCLKCFG_MEMTIMU     0x80000000  // Memory Timing Register Update
+#define SYSCTL_RSCLKCFG_NEWFREQ     0x40000000  // New PLLFREQ Accept
+#define SYSCTL_RSCLKCFG_USEPLL      0x10000000  // Use PLL
+#define SYSCTL_RSCLKCFG_SRC_M       0x0FF00000  // PLL and Oscillator Source fields
+#define SYSCTL_RSCLKCFG_SRC_MOSC    0x03300000  // PLL and system clock from the MOSC
+#define SYSCTL_RSCLKCFG_PSYSDIV_M   0x000003FF  // PLL System Clock Divisor
+#define SYSCTL_PLLFREQ0_PLLPWR      0x00800000  // PLL Power
+#define SYSCTL_PLLFREQ0_M           0x000FFFFF  // MINT and MFRAC fields
+#define SYSCTL_PLLSTAT_LOCK         0x00000001  // PLL Lock
+#define SYSCTL_MEMTIM0_M            0x03EF03EF  // Flash and EEPROM timing fields
+
+/* 25 MHz crystal / (N + 1) * MINT = 480 MHz VCO, / (PSYSDIV + 1) = 120 MHz */
+#define CLOCK_XTAL_HZ       25000000
+#define CLOCK_PIOSC_HZ      16000000
+#define CLOCK_PLL_HZ        120000000
+#define CLOCK_MHZ           1000000
+#define CLOCK_PLL_MINT      96
+#define CLOCK_PLL_N         4
+#define CLOCK_PLL_PSYSDIV   3
+
+/* Flash and EEPROM wait states for 100-120 MHz: EBCHT, EWS, FBCHT, FWS */
+#define CLOCK_MEMTIM0_120MHZ ((0x6 << 22) | (0x5 << 16) | (0x6 << 6) | 0x5)
+
+/* Status register polls before giving up on the crystal or PLL */
+#define CLOCK_STARTUP_POLLS 100000
+
+#ifndef GLOBAL_CLOCK
+#define GLOBAL_CLOCK
+
+extern void Clock_Init(void);
+extern unsigned long getSystemClock(void);
+
+#endif /* GLOBAL_CLOCK */
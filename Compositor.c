@@ -0,0 +1,340 @@
+/*
+ * @file    Compositor.c
+ * @brief   Contains the UART0 screen compositor. Messages are drawn into
+ *          the screen copy at the sending process's cursor, which a
+ *          cursor position sequence in the sender's own stream moves, and
+ *          the changed span of each row is sent when the frame is flushed.
+ *          The terminal's own cursor and attribute are tracked so that
+ *          neighbouring changes are sent without repositioning.
+ *          Keystrokes are echoed into the copy from the UART0 ISR, so
+ *          the copy is only changed with interrupts disabled.
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#include <string.h>
+#include <ctype.h>
+#define GLOBAL_COMPOSITOR
+#include "Compositor.h"
+#include "Utilities.h"
+#include "UART.h"
+
+/* Terminal row when the cursor position is not known */
+#define ROW_UNKNOWN     -1
+
+/* Screen copy; the terminal is cleared at start up */
+static ScreenRow screen[SCREEN_ROWS];
+static int screenDirty = FALSE;
+
+/* Attribute given to cells as they are drawn */
+static unsigned char drawAttribute = CELL_NORMAL;
+
+/* What the terminal was last left showing */
+static int terminalRow = ROW_UNKNOWN;
+static int terminalCol = 0;
+static unsigned char terminalAttribute = CELL_NORMAL;
+
+/* Last cursor sequence sent; only the digits that change are rewritten */
+static Cursor cursor = {ESC, '[', {'0', '1'}, ';', {'0', '1'}, 'H', NUL};
+static int cursorRow = 0;
+static int cursorCol = 0;
+
+/*
+ * @brief   Blanks a row of the screen copy; the row is cleared on the
+ *          terminal at the next flush
+ * @param   [in] int row: row from zero
+ */
+static void clearRow(int row)
+{
+    memset(screen[row].cells, ' ', SCREEN_COLS);
+    memset(screen[row].attributes, CELL_NORMAL, SCREEN_COLS);
+    screen[row].first = SCREEN_COLS;
+    screen[row].last = 0;
+    screen[row].cleared = TRUE;
+    screenDirty = TRUE;
+}
+
+/*
+ * @brief   Draws a character into the screen copy, widening the row's
+ *          changed span only if the cell is different
+ * @param   [in] int row: row from zero
+ *          [in] int col: column from zero
+ *          [in] char data: character drawn
+ *          [in] unsigned char attribute: one of cellAttributes
+ */
+static void drawCell(int row, int col, char data, unsigned char attribute)
+{
+    ScreenRow * line = &screen[row];
+
+    if((col < 0) || (col >= SCREEN_COLS))
+    {
+        return;
+    }
+
+    if((line->cells[col] != data) || (line->attributes[col] != attribute))
+    {
+        line->cells[col] = data;
+        line->attributes[col] = attribute;
+        line->first = (col < line->first)? col : line->first;
+        line->last = (col > line->last)? col : line->last;
+        screenDirty = TRUE;
+    }
+}
+
+/*
+ * @brief   Draws a character at a process's cursor and advances it; an
+ *          echoed backspace erases the character before the cursor
+ * @param   [in] int row: row from zero
+ *          [in] char data: character drawn
+ *          [in/out] PCB* printingProcess: process whose cursor is used
+ *          [in] unsigned char attribute: one of cellAttributes
+ */
+static void drawCharacter(int row, char data, PCB * printingProcess, unsigned char attribute)
+{
+    if(data == BS)
+    {
+        if(printingProcess->xAxisCursorPosition > 1)
+        {
+            printingProcess->xAxisCursorPosition--;
+            drawCell(row, printingProcess->xAxisCursorPosition - 1, ' ', attribute);
+        }
+    }
+    else
+    {
+        drawCell(row, printingProcess->xAxisCursorPosition - 1, data, attribute);
+        printingProcess->xAxisCursorPosition++;
+    }
+}
+
+/*
+ * @brief   Row a process draws on. Processes placed below or above the
+ *          screen (spawned ones can be given any row) are drawn on the
+ *          nearest row rather than lost.
+ * @param   [in] PCB* printingProcess: process whose cursor is used
+ * @return  int: row from zero, within the screen
+ */
+static int screenRow(PCB * printingProcess)
+{
+    int row = printingProcess->yAxisCursorPosition - 1;
+
+    return (row < 0)? 0 : (row >= SCREEN_ROWS)? SCREEN_ROWS - 1 : row;
+}
+
+/*
+ * @brief   Takes a cursor position sequence (see formatCursor) sent by a
+ *          process as the place its following text is drawn. Carrying
+ *          the position in the message keeps it in order with the text,
+ *          however far the sender has run ahead of the output server.
+ * @param   [in] char* string: escape sequence, nul terminated
+ *          [out] PCB* printingProcess: sender, whose cursor is moved
+ * @return  int: TRUE if the string was a cursor position
+ */
+static int takeCursor(char * string, PCB * printingProcess)
+{
+    Cursor * position = (Cursor *)string;
+
+    if((strlen(string) != sizeof(Cursor) - 1) || (position->sqrbrkt != '[') ||
+       (position->semicolon != ';') || (position->cmdchar != 'H') ||
+       !isdigit((int)position->line[0]) || !isdigit((int)position->line[1]) ||
+       !isdigit((int)position->col[0]) || !isdigit((int)position->col[1]))
+    {
+        return FALSE;
+    }
+
+    printingProcess->yAxisCursorPosition = (position->line[0] - '0') * 10 + (position->line[1] - '0');
+    printingProcess->xAxisCursorPosition = (position->col[0] - '0') * 10 + (position->col[1] - '0');
+    return TRUE;
+}
+
+/*
+ * @brief   Moves the terminal cursor unless it is already in place
+ * @param   [in] int row: row from zero
+ *          [in] int col: column from zero
+ */
+static void moveTerminal(int row, int col)
+{
+    if((terminalRow != row) || (terminalCol != col))
+    {
+        if(cursorRow != row)
+        {
+            CURSOR_DIGITS(cursor.line, row + 1);
+            cursorRow = row;
+        }
+        if(cursorCol != col)
+        {
+            CURSOR_DIGITS(cursor.col, col + 1);
+            cursorCol = col;
+        }
+        systemPrintString((char *)&cursor);
+        terminalRow = row;
+        terminalCol = col;
+    }
+}
+
+/*
+ * @brief   Starts the screen copy out blank, matching the terminal
+ *          once it has been sent CLEAR_SCREEN
+ */
+void compositorInit(void)
+{
+    int row;
+
+    for(row = 0; row < SCREEN_ROWS; row++)
+    {
+        clearRow(row);
+        screen[row].cleared = FALSE;
+    }
+    screenDirty = FALSE;
+}
+
+/*
+ * @brief   Draws a message into the screen copy at the position of the
+ *          process that sent it. Strings starting with ESC are taken as
+ *          one escape sequence: cursor positions, clears and attribute
+ *          changes are applied to the copy. Anything else (such as APC data) has no place in
+ *          the copy; the frame drawn so far is flushed and the sequence
+ *          sent after it, so it keeps its order with what was drawn.
+ * @param   [in] char* string: message, nul terminated
+ *          [in/out] PCB* printingProcess: sender, whose cursor is advanced
+ */
+void compositorWrite(char * string, PCB * printingProcess)
+{
+    int row = screenRow(printingProcess);
+    unsigned long mask = get_PRIMASK();
+    int i;
+
+    disable();
+    if(*string == ESC)
+    {
+        if(!strcmp(string, CLEAR_LINE))
+        {
+            clearRow(row);
+        }
+        else if(!strcmp(string, CLEAR_SCREEN))
+        {
+            for(i = 0; i < SCREEN_ROWS; i++)
+            {
+                clearRow(i);
+            }
+        }
+        else if(!strcmp(string, RED_TEXT))
+        {
+            drawAttribute = CELL_HIGHLIGHT;
+        }
+        else if(!strcmp(string, CLEAR_MODE))
+        {
+            drawAttribute = CELL_NORMAL;
+        }
+        else if(takeCursor(string, printingProcess))
+        {
+            /* Nothing is drawn until the text that follows */
+        }
+        else
+        {
+            /* Sent as is; the ring may block, so interrupts go back on */
+            set_PRIMASK(mask);
+            compositorFlush();
+            systemPrintString(string);
+            terminalRow = ROW_UNKNOWN;
+        }
+    }
+    else
+    {
+        while(*string)
+        {
+            drawCharacter(row, *string++, printingProcess, drawAttribute);
+        }
+    }
+    set_PRIMASK(mask);
+}
+
+/*
+ * @brief   Draws a keystroke echoed by the UART0 receive ISR at the
+ *          position of the process collecting the line
+ * @param   [in] char data: character, or BS to erase the last one
+ *          [in/out] PCB* inputProcess: process whose cursor is advanced
+ * @return  int: TRUE if the screen was clean and the output server has
+ *          to be woken to flush it
+ */
+int compositorEcho(char data, PCB * inputProcess)
+{
+    int wasDirty = screenDirty;
+
+    drawCharacter(screenRow(inputProcess), data, inputProcess, CELL_NORMAL);
+    return (!wasDirty && screenDirty);
+}
+
+/*
+ * @brief   Sends every changed span to the terminal, top to bottom
+ */
+void compositorFlush(void)
+{
+    int row;
+    int col;
+    int first;
+    int last;
+    int cleared;
+    ScreenRow * line;
+
+    /* Anything echoed while the frame is sent dirties the screen again */
+    disable();
+    screenDirty = FALSE;
+    enable();
+
+    for(row = 0; row < SCREEN_ROWS; row++)
+    {
+        line = &screen[row];
+
+        /* Take the row's changes; cells echoed into it from here on
+         * start a new span and go out with the next frame
+         */
+        disable();
+        first = line->first;
+        last = line->last;
+        cleared = line->cleared;
+        line->first = SCREEN_COLS;
+        line->last = 0;
+        line->cleared = FALSE;
+        enable();
+
+        if(cleared)
+        {
+            moveTerminal(row, 0);
+            systemPrintString(CLEAR_LINE);
+        }
+
+        if(first <= last)
+        {
+            moveTerminal(row, first);
+            for(col = first; col <= last; col++)
+            {
+                if(line->attributes[col] != terminalAttribute)
+                {
+                    systemPrintString((line->attributes[col] == CELL_HIGHLIGHT)?
+                                      RED_TEXT : CLEAR_MODE);
+                    terminalAttribute = line->attributes[col];
+                }
+                uart0Put(line->cells[col]);
+            }
+
+            /* The cursor stays put after the last column */
+            terminalCol = col;
+            terminalRow = (col < SCREEN_COLS)? row : ROW_UNKNOWN;
+        }
+    }
+
+    if(terminalAttribute != CELL_NORMAL)
+    {
+        systemPrintString(CLEAR_MODE);
+        terminalAttribute = CELL_NORMAL;
+    }
+}
+
+/*
+ * @brief   Whether anything is waiting to be flushed
+ * @return  int: TRUE if the screen copy differs from the terminal
+ */
+int compositorDirty(void)
+{
+    return screenDirty;
+}
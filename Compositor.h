@@ -0,0 +1,50 @@
+/*
+ * @file    Compositor.h
+ * @brief   Contains the definitions of the UART0 screen compositor. The
+ *          output server draws every message into a copy of the terminal
+ *          held in RAM; only cells that changed are sent, once a frame.
+ *          The UART0 receive ISR draws its echo into the same copy.
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#pragma once
+#include "Process.h"
+
+/* Size of the terminal, matching the two digit cursor sequence */
+#define SCREEN_ROWS     24
+#define SCREEN_COLS     80
+
+/* SysTick ticks between flushes, 25 frames a second */
+#define COMPOSITOR_FRAME_TICKS  4
+
+/* Cell attributes, selected by RED_TEXT and CLEAR_MODE */
+enum cellAttributes {CELL_NORMAL, CELL_HIGHLIGHT};
+
+/* A row of the screen and the span of it changed since the last flush */
+typedef struct ScreenRow_
+{
+    char cells[SCREEN_COLS];
+    unsigned char attributes[SCREEN_COLS];
+    /* first > last when nothing changed */
+    unsigned char first;
+    unsigned char last;
+    /* Row was blanked and is cleared with one escape rather than spaces */
+    unsigned char cleared;
+
+}ScreenRow;
+
+#ifndef GLOBAL_COMPOSITOR
+#define GLOBAL_COMPOSITOR
+
+extern void compositorInit(void);
+extern void compositorWrite(char *, PCB *);
+extern int compositorEcho(char, PCB *);
+extern void compositorFlush(void);
+extern int compositorDirty(void);
+
+#else
+
+void compositorFlush(void);
+
+#endif /* GLOBAL_COMPOSITOR */
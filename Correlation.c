@@ -0,0 +1,86 @@
+/*
+ * @file    Correlation.c
+ * @brief   Contains the per-hop latency histograms of correlated work.
+ *          A process starts a correlation; every message or channel
+ *          element it then sends carries the ID and the time the sender
+ *          took the work on. The receiver adopts both, so each hop measures
+ *          the time spent in the previous layer plus the time queued, and
+ *          the hops of one request add up to its end-to-end latency.
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#include <string.h>
+#include "SVC.h"
+#include "SYSTICK.h"
+#define GLOBAL_CORRELATION
+#include "Correlation.h"
+
+/*Latency of correlated work arriving at each hop*/
+static HopStats hopStats[HOP_AMOUNT];
+
+/*Last correlation ID handed out*/
+static unsigned int lastCorrelation = CORRELATION_NONE;
+
+/*
+ * @brief   Hands work to the process that received it. Correlated work
+ *          records the hop it just made; uncorrelated work ends whatever
+ *          the process was following. Channel hops are recorded by their
+ *          consumer outside the kernel, with interrupts disabled so the
+ *          update cannot interleave with the kernel's own.
+ * @param   [in/out] PCB * receiver: PCB of the receiving process
+ *          [in] unsigned int correlation: ID carried by the work
+ *          [in] unsigned long stamp: time the sender took the work on
+ *          [in] int hop: mailbox index or CHANNEL_HOP of the arrival
+ */
+void adoptCorrelation(PCB * receiver, unsigned int correlation, unsigned long stamp, int hop)
+{
+    unsigned long now;
+
+    receiver->correlation = correlation;
+    if(correlation != CORRELATION_NONE)
+    {
+        now = getKernelTime();
+        hopStats[hop].count++;
+        hopStats[hop].latency[latencyBucket(now - stamp)]++;
+        receiver->correlationStamp = now;
+    }
+}
+
+/*
+ * @brief   Starts or ends the running process' correlation
+ * @param   [in] int start: TRUE to start a new correlation, FALSE to end it
+ * @return  unsigned int: the new correlation ID, CORRELATION_NONE once ended
+ */
+unsigned int kernelCorrelate(int start)
+{
+    PCB * running = getRunningPCB();
+
+    running->correlation = CORRELATION_NONE;
+    if(start)
+    {
+        /* IDs wrap but never become CORRELATION_NONE */
+        if(++lastCorrelation == CORRELATION_NONE)
+        {
+            lastCorrelation++;
+        }
+        running->correlation = lastCorrelation;
+        running->correlationStamp = getKernelTime();
+    }
+    return running->correlation;
+}
+
+/*
+ * @brief   Copies out the latency histogram of one hop
+ * @param   [in] int hop: mailbox index or CHANNEL_HOP
+ *          [out] HopStats* stats: where the histogram is copied
+ * @return  int: -1->invalid hop, 1->success
+ */
+int kernelGetHopStats(int hop, HopStats * stats)
+{
+    if((hop < 0) || (hop >= HOP_AMOUNT))
+    {return FAILURE;}
+
+    memcpy(stats, &hopStats[hop], sizeof(HopStats));
+    return SUCCESS;
+}
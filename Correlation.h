@@ -0,0 +1,39 @@
+/*
+ * @file    Correlation.h
+ * @brief   Contains the correlation ID definitions used to time a request
+ *          as it crosses the protocol layers. The ID travels with message
+ *          and channel metadata, never on the wire.
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#pragma once
+#include "Process.h"
+#include "Messages.h"
+#include "Channel.h"
+
+/* Correlation ID of work nobody asked to follow */
+#define CORRELATION_NONE    0
+
+/* A hop is the arrival of correlated work at a mailbox or channel; hops
+ * are numbered by mailbox index, then by channel id
+ */
+#define HOP_AMOUNT          (MAILBOX_AMOUNT + CHANNEL_AMOUNT)
+#define CHANNEL_HOP(id)     (MAILBOX_AMOUNT + (id))
+
+/* Histogram of one hop's latency, in the buckets used by MailBoxStats */
+typedef struct HopStats_
+{
+    unsigned long count;
+    unsigned long latency[LATENCY_BUCKETS];
+
+}HopStats;
+
+#ifndef GLOBAL_CORRELATION
+#define GLOBAL_CORRELATION
+
+extern void adoptCorrelation(PCB *, unsigned int, unsigned long, int);
+extern unsigned int kernelCorrelate(int);
+extern int kernelGetHopStats(int, HopStats *);
+
+#endif /* GLOBAL_CORRELATION */
@@ -13,6 +13,7 @@
 #include "DataLinkMessage.h"
 #include "PhysLayerMessage.h"
 #include "Utilities.h"
+#include "Log.h"
 
 
 /* Definition of sliding window size */
@@ -32,23 +33,22 @@ DLControl DLState = {0, 0, DATA};
  */
 DLMessage sentQueue[MAX_SEQUENCE];
 
+/* Traffic counters, guarded by DATALINK_MUTEX like DLState */
+static DLCounters linkCounters;
+
 
 /*
- * @brief   Routine used to re-send all failed messages
+ * @brief   Routine used to re-send all failed messages. The caller
+ *          must hold DATALINK_MUTEX.
  * @param   [in] unsigned char start: Starting index to start
  *          re-sending from
  */
-inline void forwardMessages(unsigned char start)
+static inline void forwardMessages(unsigned char start)
 {
     unsigned char i;
     int fwdSize = sizeof(DLMessage);
     union DLFromMB toForward;
 
-    //TODO: What if two processes call this function at once?
-    //      No harm can be done from this but it could be really
-    //      inefficient to not handle it. Though it is unlikely to
-    //      occur in the first place.
-
     /* Loop through all messages to re-send */
     for(i = start; i != DLState.sequenceNum; i = INCREMENT_SEQUENCE(i))
     {
@@ -57,12 +57,28 @@ inline void forwardMessages(unsigned char start)
 
         /* Send this message to the physical layer */
         sendMessage(DATALINKPHYSMB, PHYSDATALINKMB, toForward.recvAddr, fwdSize);
+        linkCounters.retransmitted++;
+        LOG(LOG_RETRANSMIT, i, DLState.sequenceNum);
     }
 
     return;
 }
 
 
+/*
+ * @brief   Copies out the data link traffic counters
+ * @param   [out] DLCounters* counters: where the counters are copied
+ */
+void getDataLinkCounters(DLCounters * counters)
+{
+    mutexLock(DATALINK_MUTEX);
+    *counters = linkCounters;
+    mutexUnlock(DATALINK_MUTEX);
+
+    return;
+}
+
+
 /*
  * @brief   Handler of messages to data link layer
  *          from application layer. Prepares these messages
@@ -96,9 +112,14 @@ void DataLinkfromAppHandler(void)
         /* Loop indefinitely while processing messages from application layer */
         while(1)
         {
-            /* Receive message from dedicated mailbox. These messages follow the AppLayerMessage format */
+            /* Receive message from dedicated mailbox, urgent requests first.
+             * These messages follow the AppLayerMessage format
+             */
             recvMessage(APPDATALINKMB, &senderMB, received.recvAddr, &recvSize);
 
+            /* Sequence numbers and the sent queue are shared with the physical layer handler */
+            mutexLock(DATALINK_MUTEX);
+
             /* Fill control field of message to forward with current data link state.
              * Note that the type field of our saved DLState is not ever changed from DATA.
              */
@@ -107,14 +128,20 @@ void DataLinkfromAppHandler(void)
             /* Assemble message to forward */
             toForward.msgAddr->length = recvSize;
 
-            /* Forward message to physical layer */
+            /* Forward message to physical layer. Once sequenced, frames must
+             * leave in order; an urgent frame overtaking earlier ones would
+             * be NACKed and resent behind them
+             */
             sendMessage(DATALINKPHYSMB, APPDATALINKMB, toForward.recvAddr, fwdSize);
+            linkCounters.framesSent++;
 
             /* Copy this message to the sent queue in case of failure */
             sentQueue[DLState.sequenceNum] = *(toForward.msgAddr);
 
             /* Increment Sequence Number of Current State */
             DLState.sequenceNum = INCREMENT_SEQUENCE(DLState.sequenceNum);
+
+            mutexUnlock(DATALINK_MUTEX);
         }
     }
 
@@ -162,6 +189,10 @@ void DataLinkfromPhysHandler(void)
             /* Receive message from dedicated mailbox. These messages follow the DataLinkMessage format */
             recvMessage(PHYSDATALINKMB, &senderMB, received.recvAddr, &recvSize);
 
+            /* Sequence numbers and the sent queue are shared with the application layer handler */
+            mutexLock(DATALINK_MUTEX);
+            linkCounters.framesReceived++;
+
             /* Act on received message's type */
             switch(received.msgAddr->control.type)
             {
@@ -173,11 +204,13 @@ void DataLinkfromPhysHandler(void)
                     /* Sequence number mismatch has occurred so must send NACK reply and
                      * discard the received packet.
                      */
+                    LOG(LOG_NACK_SENT, received.msgAddr->control.sequenceNum, DLState.receivedNum);
                     received.msgAddr->control = DLState;
                     received.msgAddr->control.type = NACK;
 
                     /* Send this reply to the physical layer for forwarding to the train set */
                     sendMessage(DATALINKPHYSMB, PHYSDATALINKMB, received.recvAddr, ctlSize);
+                    linkCounters.nacksSent++;
                 }
                 else
                 {
@@ -193,22 +226,36 @@ void DataLinkfromPhysHandler(void)
                     received.msgAddr->control = DLState;
                     received.msgAddr->control.type = ACK;
                     sendMessage(DATALINKPHYSMB, PHYSDATALINKMB, received.recvAddr, ctlSize);
+                    linkCounters.acksSent++;
 
-                    /* Send non-data link portion of received message to application layer */
-                    sendMessage(DATALINKAPPMB, PHYSDATALINKMB, toForward.recvAddr, fwdSize);
+                    /* Publish hall sensor events to every subscriber; send anything else
+                     * straight to the application layer
+                     */
+                    if(toForward.msgAddr->code == HALL_TRIGGERED)
+                    {
+                        publish(HALL_SENSOR_TOPIC, PHYSDATALINKMB, toForward.recvAddr, fwdSize);
+                    }
+                    else
+                    {
+                        sendMessage(DATALINKAPPMB, PHYSDATALINKMB, toForward.recvAddr, fwdSize);
+                    }
                 }
                 break;
             /* Acknowledgment message; can discard acknowledged messages */
             case ACK:
+                linkCounters.acksReceived++;
                 //TODO: When time server is in place, need to reset timer on acknowledged messages
                 break;
             /* Negative Acknowledgment message; must forward each missed message */
             case NACK:
+                linkCounters.nacksReceived++;
                 forwardMessages(received.msgAddr->control.receivedNum);
                 break;
             default:
                 break;
             }
+
+            mutexUnlock(DATALINK_MUTEX);
         }
     }
 
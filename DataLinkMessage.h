@@ -14,6 +14,9 @@
 #define APPDATALINKMB   (8)
 #define PHYSDATALINKMB  (9)
 
+/* Mutex guarding DLState and sentQueue, shared by both data link handlers */
+#define DATALINK_MUTEX  (0)
+
 /* Enumeration of data link layer control types */
 enum DataLinkType
 {
@@ -39,6 +42,18 @@ typedef struct DataLinkMessage
   AppMessage appMessage;
 } DLMessage;
 
+/* Running counts of data link traffic, kept for diagnosis */
+typedef struct DataLinkCounters
+{
+    unsigned long framesSent;
+    unsigned long framesReceived;
+    unsigned long acksSent;
+    unsigned long nacksSent;
+    unsigned long acksReceived;
+    unsigned long nacksReceived;
+    unsigned long retransmitted;
+} DLCounters;
+
 /* Union of DLMessage pointer and character pointer */
 union DLFromMB
 {
@@ -49,3 +64,4 @@ union DLFromMB
 
 void DataLinkfromAppHandler(void);
 void DataLinkfromPhysHandler(void);
+void getDataLinkCounters(DLCounters *);
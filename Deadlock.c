@@ -0,0 +1,141 @@
+/*
+ * @file    Deadlock.c
+ * @brief   Contains the wait-for graph deadlock detector. Every time a
+ *          process blocks, the chain of processes it waits for is followed;
+ *          reaching the blocked process again means none of them can run.
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#include <string.h>
+#include "SYSTICK.h"
+#include "Messages.h"
+#include "Semaphore.h"
+#define GLOBAL_DEADLOCK
+#include "Deadlock.h"
+
+/*Most recent cycle found*/
+static DeadlockReport lastDeadlock;
+
+/*
+ * @brief   Finds the process expected to wake a blocked process. A mutex
+ *          waiter waits for the owner. A receive waits for whoever last
+ *          sent to the mailbox, which is inferred rather than certain.
+ *          Processes that an ISR or any process may wake wait for nobody.
+ * @param   [in] PCB * blocked: PCB of a blocked process
+ *          [out] int * inferred: set TRUE if the edge is a last sender
+ * @return  PCB *: the process waited for, NULL if unknown
+ */
+PCB * waitsFor(PCB * blocked, int * inferred)
+{
+    int i;
+    PCB * waker = NULL;
+
+    *inferred = FALSE;
+
+    switch(blocked->blockState)
+    {
+    case MUTEX_BLOCKED:
+        waker = getMutexOwner(blocked->waitObject);
+    break;
+    case RECV_BLOCKED:
+        if(blocked->waitMB != ANY)
+        {
+            waker = getLastSender(blocked->waitMB);
+            *inferred = TRUE;
+        }
+    break;
+    case WAIT_BLOCKED:
+        /* A notification source can always end the wait */
+        for(i = 0; !blocked->waitSources && !waker && (i < blocked->waitCount); i++)
+        {
+            waker = getLastSender(resolveMailBox(blocked->waitMailboxes[i]));
+            *inferred = TRUE;
+        }
+    break;
+    default:
+    break;
+    }
+
+    /* A process cannot be woken by itself */
+    return (waker == blocked)? NULL : waker;
+}
+
+/*
+ * @brief   Follows the wait-for chain of a process that has just blocked.
+ *          Any new cycle must pass through the edge just added, so only
+ *          this chain needs checking. A cycle is recorded for
+ *          getDeadlockReport.
+ * @param   [in] PCB * blocked: PCB of the process that blocked
+ */
+void checkWaitChain(PCB * blocked)
+{
+    int length = 0;
+    int inferred;
+    int suspected = FALSE;
+    unsigned int pids[WAIT_CHAIN_LIMIT];
+    PCB * current = blocked;
+
+    while(current && (current->blockState != READY) && (length < WAIT_CHAIN_LIMIT))
+    {
+        pids[length++] = current->pid;
+        current = waitsFor(current, &inferred);
+        suspected |= inferred;
+
+        if(current == blocked)
+        {
+            lastDeadlock.detections++;
+            lastDeadlock.detectedAt = getKernelTicks();
+            lastDeadlock.suspected = suspected;
+            lastDeadlock.length = length;
+            memcpy(lastDeadlock.pids, pids, length * sizeof(unsigned int));
+            return;
+        }
+    }
+}
+
+/*
+ * @brief   Describes every process blocked for at least a number of ticks
+ * @param   [out] WaitGraphEntry * entries: where each process is described
+ *          [in] int maxEntries: number of entries available
+ *          [in] unsigned long minTicks: shortest block reported
+ * @return  int: number of entries filled
+ */
+int kernelGetWaitGraph(WaitGraphEntry * entries, int maxEntries, unsigned long minTicks)
+{
+    int slot;
+    int count = 0;
+    PCB * process;
+    PCB * waker;
+    unsigned long now = getKernelTicks();
+
+    for(slot = 0; (slot < MAX_PROCESSES) && (count < maxEntries); slot++)
+    {
+        process = getProcess(slot);
+
+        if(!process || (process->blockState == READY) ||
+           ((now - process->blockedSince) < minTicks))
+        {continue;}
+
+        entries[count].pid = process->pid;
+        entries[count].blockState = process->blockState;
+        entries[count].object = (process->blockState == RECV_BLOCKED)?
+                                process->waitMB : process->waitObject;
+        waker = waitsFor(process, &entries[count].inferred);
+        entries[count].waitsFor = (waker)? (int)waker->pid : ANY;
+        entries[count].blockedTicks = now - process->blockedSince;
+        count++;
+    }
+    return count;
+}
+
+/*
+ * @brief   Copies out the most recent cycle found
+ * @param   [out] DeadlockReport * report: where the report is copied
+ * @return  int: number of cycles found since start up
+ */
+int kernelGetDeadlockReport(DeadlockReport * report)
+{
+    memcpy(report, &lastDeadlock, sizeof(DeadlockReport));
+    return lastDeadlock.detections;
+}
@@ -0,0 +1,61 @@
+/*
+ * @file    Deadlock.h
+ * @brief   Contains the wait-for graph structures and function prototypes
+ *          used to find processes blocked on each other
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#pragma once
+#include "Process.h"
+#include "SVC.h"
+
+/* Longest chain of waiting processes followed */
+#define WAIT_CHAIN_LIMIT    MAX_PROCESSES
+
+/* Structure describing one blocked process and who it waits for */
+typedef struct WaitGraphEntry_
+{
+    unsigned int pid;
+    /* One of blockStates */
+    int blockState;
+    /* Mailbox index, mutex or semaphore waited on, ANY if none */
+    int object;
+    /* pid of the process expected to wake it, ANY if unknown */
+    int waitsFor;
+    /* TRUE when waitsFor is only the last sender to the mailbox */
+    int inferred;
+    /* SysTick ticks spent blocked */
+    unsigned long blockedTicks;
+
+}WaitGraphEntry;
+
+/* Structure describing the most recent cycle found */
+typedef struct DeadlockReport_
+{
+    /* Cycles found since start up */
+    unsigned long detections;
+    /* Tick the latest cycle was found at */
+    unsigned long detectedAt;
+    /* TRUE if the cycle depends on a receive's last sender; the sender
+     * is the likeliest waker but any process may send to a mailbox
+     */
+    int suspected;
+    /* pids around the cycle, starting with the process that closed it */
+    int length;
+    unsigned int pids[WAIT_CHAIN_LIMIT];
+
+}DeadlockReport;
+
+#ifndef GLOBAL_DEADLOCK
+#define GLOBAL_DEADLOCK
+
+extern void checkWaitChain(PCB *);
+extern int kernelGetWaitGraph(WaitGraphEntry *, int, unsigned long);
+extern int kernelGetDeadlockReport(DeadlockReport *);
+
+#else
+
+PCB * waitsFor(PCB *, int *);
+
+#endif /* GLOBAL_DEADLOCK */
@@ -14,7 +14,6 @@
 #include "HoldingBuffer.h"
 /* Define an empty holding buffer*/
 static holdingBuffer    holdingBuffer_0 = {{EMPTY},EMPTY};
-static holdingBuffer    holdingBuffer_1 = {{EMPTY},EMPTY};
 
 /*
  * @brief   Adds a character to the holding register
@@ -62,50 +61,3 @@ char* emptyBuffer_0(void)
    holdingBuffer_0.writePtr=EMPTY;
    return holdingBuffer_0.buffer;
 }
-
-/*
- * @brief   Adds a character to the holding register
- * @param   char c: character to be added to holding register
- * @return  @return  int return used as a boolean value,
- *          if returns 1 the character was successfully added
- *          if returns 0 the holding buffer is full
- */
-int addToBuffer_1(char c)
-{
-    if(holdingBuffer_1.writePtr<MAX_BUFFER)
-    {
-        holdingBuffer_1.buffer[holdingBuffer_1.writePtr++] = c;
-        return SUCCESS;
-    }
-    return FULL;
-}
-
-/*
- * @brief   Removes a character from the holding register
- * @return  int return used as a boolean value,
- *          if returns 1 the character was successfully removed
- *          if returns 0 the holding buffer is empty
- */
-int removeFromBuffer_1(void)
-{
-    if(holdingBuffer_1.writePtr>EMPTY)
-    {
-            holdingBuffer_1.writePtr--;
-            return SUCCESS;
-    }
-    return EMPTY;
-}
-
-/*
- * @brief   Adds a NUL character to the end of
- *          the holding register, returns a pointer
- *          to the start
- * @return  char*: pointer to the first character in the
- *          holding register
- */
-char* emptyBuffer_1(void)
-{
-   addToBuffer_1(NUL);
-   holdingBuffer_1.writePtr=EMPTY;
-   return holdingBuffer_1.buffer;
-}
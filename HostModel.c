@@ -0,0 +1,486 @@
+/*
+ * @file    HostModel.c
+ * @brief   Simulated peripherals for running the drivers off-board.
+ *          Register accesses made through REG_READ and REG_WRITE land
+ *          here when HOST_MODEL is predefined. A host harness feeds the
+ *          model (received bytes, elapsed cycles, line time) and calls
+ *          hostService to take pending interrupts, one at a time.
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#include <string.h>
+#define GLOBAL_HOST_MODEL
+#include "HostModel.h"
+#include "UART.h"
+#include "SYSTICK.h"
+#include "Utilities.h"
+#include "Queue.h"
+
+#ifdef HOST_MODEL
+
+/* Register offsets within a UART block */
+#define UART_BLOCK_SIZE     0x1000
+#define UART_OFFSET(reg)    ((unsigned long)(reg) - (unsigned long)UART0_DR_R)
+#define UART_FR_TXFE        0x00000080  // UART Transmit FIFO Empty
+#define UART_FR_BUSY        0x00000008  // UART Busy
+#define UART_IFLS_RX(ifls)  (((ifls) >> 3) & 0x7)
+#define UART_IFLS_TX(ifls)  ((ifls) & 0x7)
+
+/* Registers the model has no behaviour for are simply stored */
+#define HOST_PLAIN_REGISTERS 32
+
+/* Exception numbers reported by get_IPSR while a handler runs */
+#define HOST_EXCEPTION_SYSTICK  15
+#define HOST_EXCEPTION_IRQ      16
+
+#define ST_CURRENT_MASK     0x00FFFFFF
+#define NVIC_INT_CTRL_PENDSTCLR 0x02000000
+#define NVIC_INT_CTRL_PENDSVCLR 0x08000000
+
+/* State of one simulated UART */
+typedef struct HostUart_
+{
+    unsigned char rx[HOST_UART_FIFO_DEPTH];
+    unsigned char tx[HOST_UART_FIFO_DEPTH];
+    int rxHead;
+    int rxCount;
+    int txHead;
+    int txCount;
+    /* Raw interrupt status, cleared through ICR */
+    unsigned long ris;
+    unsigned long im;
+    unsigned long ifls;
+    unsigned long lcrh;
+    unsigned long ctl;
+    unsigned long ibrd;
+    unsigned long fbrd;
+
+}HostUart;
+
+/* A stored register without side effects */
+typedef struct PlainRegister_
+{
+    unsigned long address;
+    unsigned long value;
+
+}PlainRegister;
+
+static HostUart hostUarts[HOST_UART_AMOUNT];
+static PlainRegister plainRegisters[HOST_PLAIN_REGISTERS];
+static int plainCount = 0;
+
+static unsigned long stCtrl = 0;
+static unsigned long stReload = 0;
+static unsigned long stCurrent = 0;
+static unsigned long intCtrl = 0;
+
+/* Interrupt mask and active exception of the simulated core. Handlers
+ * are only called from hostService, so disable() has nothing to hold off
+ * and the mask is just what set_PRIMASK last restored.
+ */
+static unsigned long hostPrimask = 0;
+static unsigned long hostException = 0;
+
+/* FIFO fill levels selected by IFLS, in eighths of the FIFO */
+static const int fifoEighths[] = {1, 2, 4, 6, 7, 7, 7, 7};
+
+/*
+ * @brief   Finds the UART a register belongs to
+ * @param   [in] volatile unsigned long* reg: register address
+ * @return  HostUart*: the UART, or NULL for any other register
+ */
+static HostUart * uartOf(volatile unsigned long * reg)
+{
+    unsigned long offset = UART_OFFSET(reg);
+    int uart = offset / UART_BLOCK_SIZE;
+
+    return ((unsigned long)reg >= (unsigned long)UART0_DR_R && uart < HOST_UART_AMOUNT)?
+            &hostUarts[uart] : NULL;
+}
+
+/*
+ * @brief   Depth of a UART's FIFOs as set by LCRH
+ */
+static int fifoDepth(HostUart * uart)
+{
+    return (uart->lcrh & UART_LCRH_FEN)? HOST_UART_FIFO_DEPTH : 1;
+}
+
+/*
+ * @brief   Number of bytes that raises the receive interrupt
+ */
+static int rxLevel(HostUart * uart)
+{
+    return (uart->lcrh & UART_LCRH_FEN)?
+            fifoEighths[UART_IFLS_RX(uart->ifls)] * HOST_UART_FIFO_DEPTH / 8 : 1;
+}
+
+/*
+ * @brief   Number of bytes the TX FIFO must drain to before it interrupts
+ */
+static int txLevel(HostUart * uart)
+{
+    return (uart->lcrh & UART_LCRH_FEN)?
+            fifoEighths[UART_IFLS_TX(uart->ifls)] * HOST_UART_FIFO_DEPTH / 8 : 0;
+}
+
+/*
+ * @brief   Finds or adds the stored value of a register without a model
+ */
+static unsigned long * plainRegister(volatile unsigned long * reg)
+{
+    int i;
+
+    for(i = 0; i < plainCount; i++)
+    {
+        if(plainRegisters[i].address == (unsigned long)reg)
+        {
+            return &plainRegisters[i].value;
+        }
+    }
+
+    if(plainCount == HOST_PLAIN_REGISTERS)
+    {
+        /* Out of space; such writes are dropped */
+        static unsigned long scratch;
+        scratch = 0;
+        return &scratch;
+    }
+
+    plainRegisters[plainCount].address = (unsigned long)reg;
+    plainRegisters[plainCount].value = 0;
+    return &plainRegisters[plainCount++].value;
+}
+
+/*
+ * @brief   Model of a UART register read
+ */
+static unsigned long uartRead(HostUart * uart, unsigned long offset)
+{
+    unsigned long value = 0;
+
+    switch(offset)
+    {
+    case 0x000: /* DR: pop the receive FIFO */
+        if(uart->rxCount)
+        {
+            value = uart->rx[uart->rxHead];
+            uart->rxHead = (uart->rxHead + 1) % HOST_UART_FIFO_DEPTH;
+            uart->rxCount--;
+            if(uart->rxCount < rxLevel(uart))
+            {
+                uart->ris &= ~UART_INT_RX;
+            }
+        }
+        break;
+    case 0x018: /* FR */
+        value |= (uart->rxCount == 0)? UART_FR_RXFE : 0;
+        value |= (uart->txCount == fifoDepth(uart))? UART_FR_TXFF : 0;
+        value |= (uart->txCount == 0)? UART_FR_TXFE : UART_FR_BUSY;
+        break;
+    case 0x024: value = uart->ibrd; break;
+    case 0x028: value = uart->fbrd; break;
+    case 0x02C: value = uart->lcrh; break;
+    case 0x030: value = uart->ctl; break;
+    case 0x034: value = uart->ifls; break;
+    case 0x038: value = uart->im; break;
+    case 0x03C: value = uart->ris; break;
+    case 0x040: value = uart->ris & uart->im; break;
+    default: break;
+    }
+
+    return value;
+}
+
+/*
+ * @brief   Model of a UART register write
+ */
+static void uartWrite(HostUart * uart, unsigned long offset, unsigned long value)
+{
+    switch(offset)
+    {
+    case 0x000: /* DR: push the transmit FIFO, dropped when full */
+        if(uart->txCount < fifoDepth(uart))
+        {
+            uart->tx[(uart->txHead + uart->txCount) % HOST_UART_FIFO_DEPTH] = value;
+            uart->txCount++;
+            if(uart->txCount > txLevel(uart))
+            {
+                uart->ris &= ~UART_INT_TX;
+            }
+        }
+        break;
+    case 0x024: uart->ibrd = value; break;
+    case 0x028: uart->fbrd = value; break;
+    case 0x02C: uart->lcrh = value; break;
+    case 0x030: uart->ctl = value; break;
+    case 0x034: uart->ifls = value; break;
+    case 0x038: uart->im = value; break;
+    case 0x044: uart->ris &= ~value; break; /* ICR */
+    default: break;
+    }
+}
+
+/*
+ * @brief   Register read through the HOST_MODEL backend
+ * @param   [in] volatile unsigned long* reg: register address
+ * @return  unsigned long: value the peripheral would return
+ */
+unsigned long hostRegRead(volatile unsigned long * reg)
+{
+    HostUart * uart = uartOf(reg);
+    unsigned long value;
+
+    if(uart)
+    {
+        return uartRead(uart, UART_OFFSET(reg) % UART_BLOCK_SIZE);
+    }
+
+    if(reg == ST_CTRL_R)
+    {
+        /* COUNT clears on read */
+        value = stCtrl;
+        stCtrl &= ~ST_CTRL_COUNT;
+        return value;
+    }
+    if(reg == ST_RELOAD_R)
+    {
+        return stReload;
+    }
+    if(reg == ST_CURRENT_R)
+    {
+        return stCurrent;
+    }
+    if(reg == NVIC_INT_CTRL_R)
+    {
+        return intCtrl;
+    }
+
+    return *plainRegister(reg);
+}
+
+/*
+ * @brief   Register write through the HOST_MODEL backend
+ * @param   [in] volatile unsigned long* reg: register address
+ *          [in] unsigned long value: value written
+ */
+void hostRegWrite(volatile unsigned long * reg, unsigned long value)
+{
+    HostUart * uart = uartOf(reg);
+
+    if(uart)
+    {
+        uartWrite(uart, UART_OFFSET(reg) % UART_BLOCK_SIZE, value);
+    }
+    else if(reg == ST_CTRL_R)
+    {
+        stCtrl = value & ~ST_CTRL_COUNT;
+    }
+    else if(reg == ST_RELOAD_R)
+    {
+        stReload = value & ST_CURRENT_MASK;
+    }
+    else if(reg == ST_CURRENT_R)
+    {
+        /* Any write clears the counter */
+        stCurrent = 0;
+        stCtrl &= ~ST_CTRL_COUNT;
+    }
+    else if(reg == NVIC_INT_CTRL_R)
+    {
+        intCtrl |= value & (NVIC_INT_CTRL_PENDSTSET | NVIC_INT_CTRL_PENDSVSET);
+        intCtrl &= (value & NVIC_INT_CTRL_PENDSTCLR)? ~NVIC_INT_CTRL_PENDSTSET : ~0UL;
+        intCtrl &= (value & NVIC_INT_CTRL_PENDSVCLR)? ~NVIC_INT_CTRL_PENDSVSET : ~0UL;
+    }
+    else
+    {
+        *plainRegister(reg) = value;
+    }
+}
+
+/*
+ * @brief   Host stand-ins for the special register helpers in Process.c
+ */
+unsigned long get_PRIMASK(void)
+{
+    return hostPrimask;
+}
+
+void set_PRIMASK(volatile unsigned long mask)
+{
+    hostPrimask = mask;
+}
+
+unsigned long get_IPSR(void)
+{
+    return hostException;
+}
+
+/*
+ * @brief   Returns every modelled peripheral to its reset state
+ */
+void hostReset(void)
+{
+    memset(hostUarts, 0, sizeof(hostUarts));
+    plainCount = 0;
+    stCtrl = 0;
+    stReload = 0;
+    stCurrent = 0;
+    intCtrl = 0;
+    hostPrimask = 0;
+    hostException = 0;
+}
+
+/*
+ * @brief   A byte arrives on a UART's receive line
+ * @param   [in] int uart: UART0 or UART1
+ *          [in] unsigned char data: byte received
+ * @return  int: SUCCESS, or FAILURE when the FIFO overran
+ */
+int hostUartReceive(int uart, unsigned char data)
+{
+    HostUart * model = &hostUarts[uart];
+
+    if(model->rxCount == fifoDepth(model))
+    {
+        return FAILURE;
+    }
+
+    model->rx[(model->rxHead + model->rxCount) % HOST_UART_FIFO_DEPTH] = data;
+    model->rxCount++;
+    if(model->rxCount >= rxLevel(model))
+    {
+        model->ris |= UART_INT_RX;
+    }
+
+    return SUCCESS;
+}
+
+/*
+ * @brief   The receive line of a UART has been idle for the timeout
+ *          period; raises RT if bytes are left below the RX level
+ * @param   [in] int uart: UART0 or UART1
+ */
+void hostUartReceiveTimeout(int uart)
+{
+    if(hostUarts[uart].rxCount)
+    {
+        hostUarts[uart].ris |= UART_INT_RT;
+    }
+}
+
+/*
+ * @brief   One character time passes on a UART's transmit line
+ * @param   [in] int uart: UART0 or UART1
+ * @return  int: the byte shifted out, or HOST_LINE_IDLE
+ */
+int hostUartTransmit(int uart)
+{
+    HostUart * model = &hostUarts[uart];
+    int data;
+
+    if(model->txCount == 0)
+    {
+        return HOST_LINE_IDLE;
+    }
+
+    data = model->tx[model->txHead];
+    model->txHead = (model->txHead + 1) % HOST_UART_FIFO_DEPTH;
+    model->txCount--;
+
+    /* TX interrupts on passing through the level, not on sitting below it */
+    if(model->txCount == txLevel(model))
+    {
+        model->ris |= UART_INT_TX;
+    }
+
+    return data;
+}
+
+/*
+ * @brief   Runs SysTick forward by a number of its clock cycles
+ * @param   [in] unsigned long cycles: cycles elapsed
+ */
+void hostSysTickAdvance(unsigned long cycles)
+{
+    unsigned long period = stReload + 1;
+
+    if(!(stCtrl & ST_CTRL_ENABLE) || stReload == 0)
+    {
+        return;
+    }
+
+    while(cycles)
+    {
+        if(cycles <= stCurrent)
+        {
+            stCurrent -= cycles;
+            cycles = 0;
+        }
+        else
+        {
+            /* Wrap through zero to the reload value */
+            cycles -= stCurrent + 1;
+            stCurrent = stReload;
+            stCtrl |= ST_CTRL_COUNT;
+            if(stCtrl & ST_CTRL_INTEN)
+            {
+                intCtrl |= NVIC_INT_CTRL_PENDSTSET;
+            }
+            if(cycles >= period)
+            {
+                cycles %= period;
+            }
+        }
+    }
+}
+
+/*
+ * @brief   Claims a pending PendSV so the harness can perform the switch
+ * @return  int: TRUE if PendSV was pending
+ */
+int hostTakePendSV(void)
+{
+    int pending = (intCtrl & NVIC_INT_CTRL_PENDSVSET) != 0;
+
+    intCtrl &= ~NVIC_INT_CTRL_PENDSVSET;
+    return pending;
+}
+
+/*
+ * @brief   Takes every pending and enabled interrupt by calling its
+ *          handler, as the NVIC would on leaving thread mode
+ * @return  int: number of handlers run
+ */
+int hostService(void)
+{
+    int taken = 0;
+    int i;
+    unsigned long enabled = hostRegRead(NVIC_EN0_R);
+
+    if(intCtrl & NVIC_INT_CTRL_PENDSTSET)
+    {
+        intCtrl &= ~NVIC_INT_CTRL_PENDSTSET;
+        hostException = HOST_EXCEPTION_SYSTICK;
+        SYSTICKHandler();
+        hostException = 0;
+        taken++;
+    }
+
+    for(i = 0; i < HOST_UART_AMOUNT; i++)
+    {
+        if((hostUarts[i].ris & hostUarts[i].im) &&
+           (enabled & (1 << (INT_VEC_UART0 + i))))
+        {
+            hostException = HOST_EXCEPTION_IRQ + INT_VEC_UART0 + i;
+            (i == UART0)? UART0_IntHandler() : UART1_IntHandler();
+            hostException = 0;
+            taken++;
+        }
+    }
+
+    return taken;
+}
+
+#endif /* HOST_MODEL */
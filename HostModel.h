@@ -0,0 +1,33 @@
+/*
+ * @file    HostModel.h
+ * @brief   Simulated peripherals behind the HOST_MODEL register backend.
+ *          Models the UART FIFOs and interrupt status, SysTick and the
+ *          NVIC pending and enable bits closely enough to run the real
+ *          driver and ISR code on a host. Built only when HOST_MODEL is
+ *          predefined.
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#pragma once
+#include "Registers.h"
+
+/* Hardware FIFO depth; with FIFOs disabled the depth is one */
+#define HOST_UART_FIFO_DEPTH    16
+#define HOST_UART_AMOUNT        2
+
+/* Returned by hostUartTransmit when nothing is waiting to go out */
+#define HOST_LINE_IDLE          -1
+
+#ifndef GLOBAL_HOST_MODEL
+#define GLOBAL_HOST_MODEL
+
+extern void hostReset(void);
+extern int hostUartReceive(int, unsigned char);
+extern void hostUartReceiveTimeout(int);
+extern int hostUartTransmit(int);
+extern void hostSysTickAdvance(unsigned long);
+extern int hostTakePendSV(void);
+extern int hostService(void);
+
+#endif /* GLOBAL_HOST_MODEL */
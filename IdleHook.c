@@ -0,0 +1,44 @@
+/*
+ * @file    IdleHook.c
+ * @brief   Contains the idle hook table and the routine the idle process
+ *          runs it with
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#include "Utilities.h"
+#define GLOBAL_IDLEHOOK
+#include "IdleHook.h"
+
+/*Registered hooks, run in registration order*/
+static IdleHook idleHooks[IDLE_HOOK_AMOUNT];
+static volatile int idleHookCount = 0;
+
+/*
+ * @brief   Adds a hook to the idle process' round
+ * @param   [in] IdleHook hook: routine to run when the system is idle
+ * @return  int: 1->success, -1->the table is full
+ */
+int registerIdleHook(IdleHook hook)
+{
+    if(idleHookCount >= IDLE_HOOK_AMOUNT)
+    {return FAILURE;}
+
+    /* The entry is filled before the count lets the idle process see it */
+    idleHooks[idleHookCount] = hook;
+    idleHookCount++;
+    return SUCCESS;
+}
+
+/*
+ * @brief   Runs every registered hook once
+ */
+void runIdleHooks(void)
+{
+    int i;
+
+    for(i = 0; i < idleHookCount; i++)
+    {
+        idleHooks[i]();
+    }
+}
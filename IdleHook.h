@@ -0,0 +1,27 @@
+/*
+ * @file    IdleHook.h
+ * @brief   Contains the idle hook table definitions. Hooks are short pieces
+ *          of non-urgent work run by the idle process, so only in time no
+ *          other process wants.
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#pragma once
+
+/* Most hooks registered at once */
+#define IDLE_HOOK_AMOUNT    8
+
+/* An idle hook does a bounded slice of work each call. It may be
+ * preempted at any point, so anything it shares with the kernel must be
+ * touched with interrupts disabled.
+ */
+typedef void (*IdleHook)(void);
+
+#ifndef GLOBAL_IDLEHOOK
+#define GLOBAL_IDLEHOOK
+
+extern int registerIdleHook(IdleHook);
+extern void runIdleHooks(void);
+
+#endif /* GLOBAL_IDLEHOOK */
@@ -11,6 +11,12 @@
 #include "KernelCall.h"
 #include "Process.h"
 #include "Messages.h"
+#include "Channel.h"
+#include "Deadlock.h"
+#include "SVC.h"
+#include "SYSTICK.h"
+#include "Trace.h"
+#include "Correlation.h"
 
 /*
  * @brief   Used to set R7, to point to Kernel Argument passed to SVC
@@ -48,15 +54,16 @@ int procKernelCall(int code, void* messageStruct)
 /*
  * @brief   called to bind a process to a mailbox
  * @param   [in] int desiredMB: # of MB the process wants
- *          to bind to; if equal to 16 its a bind any call
- * @return  int: -4-> bind failure; 1 -> success
+ *          to bind to; if equal to ANY its a bind any call
+ * @return  int: -4-> bind failure; 1 -> success; handle of
+ *          the mailbox bound for a bind any call
  */
 int bind(unsigned int desiredMB)
 {
     int result;
 
     /* First check whether a valid queue was requested */
-    if((desiredMB >= MAILBOX_AMOUNT) && (desiredMB != ANY))
+    if((desiredMB >= MAILBOX_AMOUNT) && (desiredMB != (unsigned int)ANY))
     {
         result = FAILURE;
     }
@@ -84,7 +91,7 @@ int bind(unsigned int desiredMB)
 int unbind(unsigned int releaseMB)
 {
     /* First check whether a valid queue was requested */
-    if(releaseMB >= MAILBOX_AMOUNT)
+    if(MB_INDEX(releaseMB) >= MAILBOX_AMOUNT)
     {
         return FAILURE;
     }
@@ -165,6 +172,7 @@ int nice(unsigned int newPriority)
 
 /*
  * @brief   Invokes the kernel to send a message to a desired Mailbox
+ *          at normal priority
  * @param   [in] int destinationMB: MB # of the destination process
  *          [in] int fromMB: MB # of the sending process
  *          [in] void* contents: data to be sent
@@ -172,11 +180,28 @@ int nice(unsigned int newPriority)
  * @return  int:  -2->send failure; 1->success
  */
 int sendMessage(int destinationMB, int fromMB, void * contents, int size)
+{
+    return sendPriorityMessage(destinationMB, fromMB, contents, size, MSG_PRIORITY_NORMAL);
+}
+
+/*
+ * @brief   Invokes the kernel to send a message to a desired Mailbox.
+ *          Higher priority messages are received before lower ones;
+ *          messages of equal priority are received in the order sent.
+ * @param   [in] int destinationMB: MB # of the destination process
+ *          [in] int fromMB: MB # of the sending process
+ *          [in] void* contents: data to be sent
+ *          [in] int size: amount of data measured in bytes
+ *          [in] int priority: MSG_PRIORITY_LOW to MSG_PRIORITY_URGENT
+ * @return  int:  -2->send failure; 1->success
+ */
+int sendPriorityMessage(int destinationMB, int fromMB, void * contents, int size, int priority)
 {
     int result;
 
-    /* First check if valid mailbox was requested */
-    if((destinationMB >= MAILBOX_AMOUNT) || (fromMB >= MAILBOX_AMOUNT))
+    /* First check if valid mailbox and priority were requested */
+    if((MB_INDEX(destinationMB) >= MAILBOX_AMOUNT) || (MB_INDEX(fromMB) >= MAILBOX_AMOUNT) ||
+       (priority < MSG_PRIORITY_LOW) || (priority >= MESSAGE_PRIORITIES))
     {
         /* Invalid mailbox was requested */
         result = FAILURE;
@@ -189,6 +214,7 @@ int sendMessage(int destinationMB, int fromMB, void * contents, int size)
         sendArgs.fromMB = fromMB;
         sendArgs.contents = contents;
         sendArgs.size = size;
+        sendArgs.priority = priority;
         result = procKernelCall(SENDMSG, &sendArgs);
     }
 
@@ -208,11 +234,28 @@ int sendMessage(int destinationMB, int fromMB, void * contents, int size)
  *
  */
 int recvMessage(unsigned int bindedMB, int * returnMB, void * contents, int * maxSize)
+{
+    return recvPriorityMessage(bindedMB, returnMB, contents, maxSize, NULL);
+}
+
+/*
+ * @brief   Invokes the kernel to receive the highest priority message from a MB
+ *          that the running process is binded to
+ * @param   [in] int bindedMB: MB # of the receiving process
+ *          [out] int* returnMB: MB # of the process that sent the message
+ *          [in/out] void* contents: address where data is stored
+ *          [in/out] int* maxSize: [in]maximum amount of bytes the process will take
+ *                                 [out] amount of bytes that were copied
+ *          [out] int* priority: priority the message was sent with; may be NULL
+ * @return  int: -3->receive failure; 1->success
+ *
+ */
+int recvPriorityMessage(unsigned int bindedMB, int * returnMB, void * contents, int * maxSize, int * priority)
 {
     int result;
 
     /* First check if valid mailbox was requested */
-    if((bindedMB >= MAILBOX_AMOUNT) && (bindedMB != ANY))
+    if((MB_INDEX(bindedMB) >= MAILBOX_AMOUNT) && (bindedMB != (unsigned int)ANY))
     {
         /* Invalid mailbox was requested */
         result = FAILURE;
@@ -225,12 +268,180 @@ int recvMessage(unsigned int bindedMB, int * returnMB, void * contents, int * ma
         recvArgs.returnMB = returnMB;
         recvArgs.contents =contents;
         recvArgs.maxSize = (int)maxSize;
+        recvArgs.priority = priority;
         result = procKernelCall(RECEIVEMSG, &recvArgs);
     }
 
     return result;
 }
 
+/*
+ * @brief   Invokes the kernel to receive every message queued in a MB that
+ *          the running process is binded to, up to maxEntries, in one trap.
+ *          Blocks if the mailbox is empty, in which case the first message
+ *          sent to the process is handed back as a batch of one.
+ * @param   [in] int bindedMB: MB # of the receiving process
+ *          [out] MessageEntry* entries: array filled with the sender, size
+ *                                       and contents of each message
+ *          [in] int maxEntries: number of entries the array can hold
+ * @return  int: -3->receive failure; otherwise number of messages received
+ */
+int recvBatch(int bindedMB, MessageEntry * entries, int maxEntries)
+{
+    int result;
+
+    /* First check if valid mailbox and entry count were requested */
+    if(((MB_INDEX(bindedMB) >= MAILBOX_AMOUNT) && (bindedMB != ANY)) || (maxEntries <= 0))
+    {
+        /* Invalid request */
+        result = RECV_FAIL;
+    }
+    else
+    {
+        /* Valid mailbox was requested to perform a batch receive */
+        ReceiveBatch batchArgs;
+        batchArgs.bindedMB = bindedMB;
+        batchArgs.entries = entries;
+        batchArgs.maxEntries = maxEntries;
+        result = procKernelCall(RECEIVEBATCH, &batchArgs);
+    }
+
+    return result;
+}
+
+/*
+ * @brief   Subscribes one of the running process' mailboxes to a topic so it
+ *          receives every message published to that topic
+ * @param   [in] int topic: index of the topic
+ *          [in] int mailbox: MB # that will receive published messages
+ * @return  int: -6->subscribe failure; 1->success
+ */
+int subscribe(int topic, int mailbox)
+{
+    volatile KernelArgs subscribeArg; /* Volatile to actually reserve space on stack */
+    subscribeArg.code = SUBSCRIBE;
+    subscribeArg.arg1 = topic;
+    subscribeArg.arg2 = mailbox;
+
+    assignR7((unsigned long) &subscribeArg);
+
+    SVC();
+
+    return subscribeArg.rtnvalue;
+}
+
+/*
+ * @brief   Stops one of the running process' mailboxes receiving a topic
+ * @param   [in] int topic: index of the topic
+ *          [in] int mailbox: MB # to remove from the topic
+ * @return  int: -6->unsubscribe failure; 1->success
+ */
+int unsubscribe(int topic, int mailbox)
+{
+    volatile KernelArgs unsubscribeArg; /* Volatile to actually reserve space on stack */
+    unsubscribeArg.code = UNSUBSCRIBE;
+    unsubscribeArg.arg1 = topic;
+    unsubscribeArg.arg2 = mailbox;
+
+    assignR7((unsigned long) &unsubscribeArg);
+
+    SVC();
+
+    return unsubscribeArg.rtnvalue;
+}
+
+/*
+ * @brief   Invokes the kernel to deliver a message to every mailbox
+ *          subscribed to a topic. The kernel copies the contents once
+ *          no matter how many subscribers there are.
+ * @param   [in] int topic: index of the topic
+ *          [in] int fromMB: MB # of the publishing process
+ *          [in] void* contents: data to be published
+ *          [in] int size: amount of data measured in bytes
+ * @return  int: -2->publish failure; otherwise number of subscribers reached
+ */
+int publish(int topic, int fromMB, void * contents, int size)
+{
+    int result;
+
+    /* First check if valid sending mailbox was requested */
+    if(MB_INDEX(fromMB) >= MAILBOX_AMOUNT)
+    {
+        result = SEND_FAIL;
+    }
+    else
+    {
+        SendMessage publishArgs;
+        publishArgs.destinationMB = topic;
+        publishArgs.fromMB = fromMB;
+        publishArgs.contents = contents;
+        publishArgs.size = size;
+        publishArgs.priority = MSG_PRIORITY_NORMAL;
+        result = procKernelCall(PUBLISH, &publishArgs);
+    }
+
+    return result;
+}
+
+/*
+ * @brief   Registers a name other processes can look the mailbox up by.
+ *          The name is released when the mailbox is unbound.
+ * @param   [in] char* name: name of the service
+ *          [in] int mailbox: MB # or handle owned by the running process
+ * @return  int: -7->name taken or registry full; 1->success
+ */
+int registerName(char * name, int mailbox)
+{
+    volatile KernelArgs nameArg; /* Volatile to actually reserve space on stack */
+    nameArg.code = REGISTERNAME;
+    nameArg.arg1 = (unsigned long)name;
+    nameArg.arg2 = mailbox;
+
+    assignR7((unsigned long) &nameArg);
+
+    SVC();
+
+    return nameArg.rtnvalue;
+}
+
+/*
+ * @brief   Looks up the mailbox handle registered for a name. Meant to be
+ *          called once at startup and the handle kept.
+ * @param   [in] char* name: name of the service
+ * @return  int: -7->name not registered; otherwise the mailbox handle
+ */
+int lookupName(char * name)
+{
+    volatile KernelArgs lookupArg; /* Volatile to actually reserve space on stack */
+    lookupArg.code = LOOKUPNAME;
+    lookupArg.arg1 = (unsigned long)name;
+
+    assignR7((unsigned long) &lookupArg);
+
+    SVC();
+
+    return lookupArg.rtnvalue;
+}
+
+/*
+ * @brief   Binds any free mailbox and registers a name for it
+ * @param   [in] char* name: name of the service
+ * @return  int: -4->bind failure; -7->name failure; otherwise the
+ *          handle of the mailbox bound
+ */
+int bindName(char * name)
+{
+    int mailbox = bind(ANY);
+
+    if((mailbox >= 0) && (registerName(name, mailbox) != SUCCESS))
+    {
+        unbind(mailbox);
+        mailbox = NAME_FAIL;
+    }
+
+    return mailbox;
+}
+
 void block(void)
 {
     volatile KernelArgs blockArg; /* Volatile to actually reserve space on stack */
@@ -246,3 +457,391 @@ void block(void)
 
 
 
+
+/*
+ * @brief   Copies out the traffic statistics of a mailbox: messages sent,
+ *          received and refused, current and peak depth, and a histogram
+ *          of the time messages spent queued
+ * @param   [in] int mailbox: MB # or handle of the mailbox
+ *          [out] MailBoxStats* stats: where the statistics are copied
+ * @return  int: -1->invalid mailbox, 1->success
+ */
+int getMailBoxStats(int mailbox, MailBoxStats * stats)
+{
+    volatile KernelArgs statsArg; /* Volatile to actually reserve space on stack */
+    statsArg.code = GETMBSTATS;
+    statsArg.arg1 = mailbox;
+    statsArg.arg2 = (unsigned long)stats;
+
+    assignR7((unsigned long) &statsArg);
+
+    SVC();
+
+    return statsArg.rtnvalue;
+}
+
+/*
+ * @brief   Blocks until one of the given mailboxes holds a message or one
+ *          of the given notification sources is signalled, letting a single
+ *          server loop multiplex mailboxes and devices. A message found is
+ *          left queued for the caller to receive.
+ * @param   [in] int* mailboxes: MB #s or handles owned by the caller
+ *          [in] int count: number of mailboxes, may be 0
+ *          [in] unsigned long sources: SOURCE_ bits to wait on, may be 0
+ *          [out] unsigned long* readySources: sources signalled since the
+ *                                             last wait on them
+ * @return  int: handle of a mailbox holding a message; -9->only
+ *          notification sources are ready; -8->invalid request
+ */
+int waitAny(int * mailboxes, int count, unsigned long sources, unsigned long * readySources)
+{
+    WaitAny waitArgs;
+
+    *readySources = NULL;
+    waitArgs.mailboxes = mailboxes;
+    waitArgs.count = count;
+    waitArgs.sources = sources;
+    waitArgs.readySources = readySources;
+
+    return procKernelCall(WAITANY, &waitArgs);
+}
+
+/*
+ * @brief   Opens a single producer, single consumer ring channel. The
+ *          producer and consumer each open the channel with the same
+ *          element size and depth and share the ring returned.
+ * @param   [in] int id: index of the channel
+ *          [in] int elemSize: most bytes of data an element holds
+ *          [in] int depth: number of slots, a power of two
+ * @return  Channel *: address of the ring, NULL on failure
+ */
+Channel * channelOpen(int id, int elemSize, int depth)
+{
+    ChannelOpen openArgs;
+    openArgs.id = id;
+    openArgs.elemSize = elemSize;
+    openArgs.depth = depth;
+
+    return (Channel *)procKernelCall(CHANNELOPEN, &openArgs);
+}
+
+/*
+ * @brief   Sleeps until the caller's side of a channel can make progress;
+ *          used by channelSend and channelReceive
+ * @param   [in] int id: index of the channel
+ *          [in] int side: CHANNEL_CONSUMER or CHANNEL_PRODUCER
+ * @return  int: -1->invalid channel, 1->success
+ */
+int channelWait(int id, int side)
+{
+    volatile KernelArgs waitArg; /* Volatile to actually reserve space on stack */
+    waitArg.code = CHANNELWAIT;
+    waitArg.arg1 = id;
+    waitArg.arg2 = side;
+
+    assignR7((unsigned long) &waitArg);
+
+    SVC();
+
+    return waitArg.rtnvalue;
+}
+
+/*
+ * @brief   Wakes the process sleeping on one side of a channel
+ * @param   [in] int id: index of the channel
+ *          [in] int side: CHANNEL_CONSUMER or CHANNEL_PRODUCER
+ * @return  int: -1->invalid channel, 1->success
+ */
+int channelSignal(int id, int side)
+{
+    volatile KernelArgs signalArg; /* Volatile to actually reserve space on stack */
+    signalArg.code = CHANNELSIGNAL;
+    signalArg.arg1 = id;
+    signalArg.arg2 = side;
+
+    assignR7((unsigned long) &signalArg);
+
+    SVC();
+
+    return signalArg.rtnvalue;
+}
+
+/*
+ * @brief   Locks a kernel mutex, blocking while another process holds it.
+ *          The holder runs at the priority of its highest waiter until it
+ *          unlocks.
+ * @param   [in] int id: index of the mutex
+ * @return  int: -10->invalid mutex or already held; 1->success
+ */
+int mutexLock(int id)
+{
+    volatile KernelArgs lockArg; /* Volatile to actually reserve space on stack */
+    lockArg.code = MUTEXLOCK;
+    lockArg.arg1 = id;
+
+    assignR7((unsigned long) &lockArg);
+
+    SVC();
+
+    return lockArg.rtnvalue;
+}
+
+/*
+ * @brief   Unlocks a kernel mutex held by the caller, handing it straight
+ *          to the highest priority waiter
+ * @param   [in] int id: index of the mutex
+ * @return  int: -10->invalid mutex or not held by the caller; 1->success
+ */
+int mutexUnlock(int id)
+{
+    volatile KernelArgs unlockArg; /* Volatile to actually reserve space on stack */
+    unlockArg.code = MUTEXUNLOCK;
+    unlockArg.arg1 = id;
+
+    assignR7((unsigned long) &unlockArg);
+
+    SVC();
+
+    return unlockArg.rtnvalue;
+}
+
+/*
+ * @brief   Sets the count of a counting semaphore
+ * @param   [in] int id: index of the semaphore
+ *          [in] int count: initial count
+ * @return  int: -10->invalid semaphore or count, or processes are still
+ *          waiting on it; 1->success
+ */
+int semInit(int id, int count)
+{
+    volatile KernelArgs initArg; /* Volatile to actually reserve space on stack */
+    initArg.code = SEMINIT;
+    initArg.arg1 = id;
+    initArg.arg2 = count;
+
+    assignR7((unsigned long) &initArg);
+
+    SVC();
+
+    return initArg.rtnvalue;
+}
+
+/*
+ * @brief   Takes a counting semaphore, blocking while its count is zero
+ * @param   [in] int id: index of the semaphore
+ * @return  int: -10->invalid semaphore; 1->success
+ */
+int semWait(int id)
+{
+    volatile KernelArgs waitArg; /* Volatile to actually reserve space on stack */
+    waitArg.code = SEMWAIT;
+    waitArg.arg1 = id;
+
+    assignR7((unsigned long) &waitArg);
+
+    SVC();
+
+    return waitArg.rtnvalue;
+}
+
+/*
+ * @brief   Gives a counting semaphore, waking its highest priority waiter
+ * @param   [in] int id: index of the semaphore
+ * @return  int: -10->invalid semaphore; 1->success
+ */
+int semSignal(int id)
+{
+    volatile KernelArgs signalArg; /* Volatile to actually reserve space on stack */
+    signalArg.code = SEMSIGNAL;
+    signalArg.arg1 = id;
+
+    assignR7((unsigned long) &signalArg);
+
+    SVC();
+
+    return signalArg.rtnvalue;
+}
+
+/*
+ * @brief   Lists the processes that have been blocked for at least a number
+ *          of ticks, what each waits on and which process is expected to
+ *          wake it, so stalled chains can be followed
+ * @param   [out] WaitGraphEntry* entries: where each process is described
+ *          [in] int maxEntries: number of entries available
+ *          [in] unsigned long minTicks: shortest block reported
+ * @return  int: number of entries filled
+ */
+int getWaitGraph(WaitGraphEntry * entries, int maxEntries, unsigned long minTicks)
+{
+    WaitGraph graphArgs;
+    graphArgs.entries = entries;
+    graphArgs.maxEntries = maxEntries;
+    graphArgs.minTicks = minTicks;
+
+    return procKernelCall(GETWAITGRAPH, &graphArgs);
+}
+
+/*
+ * @brief   Copies out the most recent cycle of processes found waiting on
+ *          each other
+ * @param   [out] DeadlockReport* report: where the report is copied
+ * @return  int: number of cycles found since start up, 0 if none
+ */
+int getDeadlockReport(DeadlockReport * report)
+{
+    return procKernelCall(GETDEADLOCK, report);
+}
+
+/*
+ * @brief   Copies out the pid, priorities, state and CPU time of
+ *          every registered process
+ * @param   [out] ProcessInfo* list: where each process is described
+ *          [in] int maxEntries: number of entries available
+ * @return  int: number of entries filled
+ */
+int getProcessList(ProcessInfo * list, int maxEntries)
+{
+    volatile KernelArgs listArg; /* Volatile to actually reserve space on stack */
+    listArg.code = GETPROCESSES;
+    listArg.arg1 = (unsigned long)list;
+    listArg.arg2 = maxEntries;
+
+    assignR7((unsigned long) &listArg);
+
+    SVC();
+
+    return listArg.rtnvalue;
+}
+
+/*
+ * @brief   Copies out the owner and queue depth of every bound mailbox
+ * @param   [out] MailBoxInfo* list: where each mailbox is described
+ *          [in] int maxEntries: number of entries available
+ * @return  int: number of entries filled
+ */
+int getMailBoxList(MailBoxInfo * list, int maxEntries)
+{
+    volatile KernelArgs listArg; /* Volatile to actually reserve space on stack */
+    listArg.code = GETMAILBOXES;
+    listArg.arg1 = (unsigned long)list;
+    listArg.arg2 = maxEntries;
+
+    assignR7((unsigned long) &listArg);
+
+    SVC();
+
+    return listArg.rtnvalue;
+}
+
+/*
+ * @brief   Copies out the free, total and low water counts of the
+ *          kernel message pools
+ * @param   [out] PoolInfo* info: where the counts are copied
+ */
+void getPoolInfo(PoolInfo * info)
+{
+    procKernelCall(GETPOOL, info);
+}
+
+/*
+ * @brief   Copies out the kernel tick count and period along with the
+ *          state of the user timer
+ * @param   [out] TimerInfo* info: where the snapshot is copied
+ */
+void getTimerInfo(TimerInfo * info)
+{
+    procKernelCall(GETTIMERS, info);
+}
+
+/*
+ * @brief   Copies out kernel trace records, oldest first. Reading from
+ *          start 0 stops tracing until a read returns 0, so read on to
+ *          the end once started.
+ * @param   [out] TraceRecord* records: where the records are copied
+ *          [in] int start: number of records already read
+ *          [in] int maxRecords: number of records available
+ * @return  int: number of records copied, 0 at the end or when the
+ *          kernel is built without KERNEL_TRACE
+ */
+int getTrace(TraceRecord * records, int start, int maxRecords)
+{
+    TraceRead traceArgs;
+    traceArgs.records = records;
+    traceArgs.start = start;
+    traceArgs.maxRecords = maxRecords;
+
+    return procKernelCall(GETTRACE, &traceArgs);
+}
+
+/*
+ * @brief   Starts following the running process' next piece of work.
+ *          Messages and channel elements it sends carry the new
+ *          correlation ID, and so does whatever their receivers send on.
+ * @return  unsigned int: the correlation ID
+ */
+unsigned int startCorrelation(void)
+{
+    volatile KernelArgs correlateArg; /* Volatile to actually reserve space on stack */
+    correlateArg.code = CORRELATE;
+    correlateArg.arg1 = TRUE;
+
+    assignR7((unsigned long) &correlateArg);
+
+    SVC();
+
+    return correlateArg.rtnvalue;
+}
+
+/*
+ * @brief   Stops the running process' messages carrying its correlation ID
+ */
+void endCorrelation(void)
+{
+    volatile KernelArgs correlateArg; /* Volatile to actually reserve space on stack */
+    correlateArg.code = CORRELATE;
+    correlateArg.arg1 = FALSE;
+
+    assignR7((unsigned long) &correlateArg);
+
+    SVC();
+}
+
+/*
+ * @brief   Copies out the latency histogram of correlated work arriving
+ *          at a mailbox or channel
+ * @param   [in] int hop: mailbox index, or CHANNEL_HOP of a channel id
+ *          [out] HopStats* stats: where the histogram is copied
+ * @return  int: -1->invalid hop, 1->success
+ */
+int getHopStats(int hop, HopStats * stats)
+{
+    volatile KernelArgs hopArg; /* Volatile to actually reserve space on stack */
+    hopArg.code = GETHOPSTATS;
+    hopArg.arg1 = hop;
+    hopArg.arg2 = (unsigned long)stats;
+
+    assignR7((unsigned long) &hopArg);
+
+    SVC();
+
+    return hopArg.rtnvalue;
+}
+
+/*
+ * @brief   Starts a new process. Its PCB and stack are reused from
+ *          terminated processes when possible.
+ * @param   [in] void (*code)(void): pointer to the start of the process code
+ *          [in] int priority: priority the process starts at
+ *          [in] int stackSize: bytes of stack the process needs, at most
+ *                              STACK_CLASS_SIZE(STACK_CLASSES - 1)
+ * @return  int: pid of the new process, -1->failure
+ */
+int spawn(void (*code)(void), int priority, int stackSize)
+{
+    Spawn spawnArgs;
+    spawnArgs.code = code;
+    spawnArgs.priority = priority;
+    spawnArgs.stackSize = stackSize;
+
+    return procKernelCall(SPAWN, &spawnArgs);
+}
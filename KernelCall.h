@@ -9,8 +9,15 @@
  * @date    17-Nov-2019 (edited)
  */
 #pragma once
+#include "Utilities.h"
 
-enum kernelcallcodes {GETID, NICE, SENDMSG, RECEIVEMSG, TERMINATE, BIND, UNBIND, BLOCK};
+enum kernelcallcodes {GETID, NICE, SENDMSG, RECEIVEMSG, TERMINATE, BIND, UNBIND, BLOCK,
+                      RECEIVEBATCH, SUBSCRIBE, UNSUBSCRIBE, PUBLISH, REGISTERNAME,
+                      LOOKUPNAME, GETMBSTATS, WAITANY, CHANNELOPEN, CHANNELWAIT,
+                      CHANNELSIGNAL, MUTEXLOCK, MUTEXUNLOCK, SEMINIT, SEMWAIT,
+                      SEMSIGNAL, GETWAITGRAPH, GETDEADLOCK, GETPROCESSES,
+                      GETMAILBOXES, GETPOOL, GETTIMERS, GETTRACE, CORRELATE,
+                      GETHOPSTATS, SPAWN};
 /*
  * @brief   Kernel Argument Structure
  * @details Holds all variables passed to kernel
@@ -27,7 +34,8 @@ typedef struct KernelCallArgs_
 /*
  * @brief   Send Kernel Call Arguments
  * @details Holds all variables passed to kernel
- *          for when a send message call is made
+ *          for when a send message call is made.
+ *          Publish calls pass the topic in destinationMB
  */
 typedef struct SendMessage_
 {
@@ -35,6 +43,7 @@ typedef struct SendMessage_
     int fromMB;
     void * contents;
     int size;
+    int priority;
 }SendMessage;
 
 /*
@@ -48,8 +57,106 @@ typedef struct ReceiveMessage_
     int * returnMB;
     void * contents;
     int maxSize;
+    int * priority;
 }ReceiveMessage;
 
+/*
+ * @brief   Batch Receive Entry
+ * @details Holds a single message handed back by
+ *          a batched receive, along with its sender
+ *          and the number of bytes copied
+ */
+typedef struct MessageEntry_
+{
+    int from;
+    int size;
+    int priority;
+    char contents[MESSAGE_SYS_LIMIT];
+}MessageEntry;
+
+/*
+ * @brief   Batch Receive Kernel Call Arguments
+ * @details Holds all variables passed to kernel
+ *          for when a batch of messages is received
+ */
+typedef struct ReceiveBatch_
+{
+    int bindedMB;
+    MessageEntry * entries;
+    int maxEntries;
+}ReceiveBatch;
+
+/*
+ * @brief   Wait Kernel Call Arguments
+ * @details Holds all variables passed to kernel
+ *          for when a process waits on several
+ *          mailboxes and notification sources
+ */
+typedef struct WaitAny_
+{
+    int * mailboxes;
+    int count;
+    unsigned long sources;
+    unsigned long * readySources;
+}WaitAny;
+
+/*
+ * @brief   Channel Open Kernel Call Arguments
+ * @details Holds all variables passed to kernel
+ *          for when a process opens a ring channel
+ */
+typedef struct ChannelOpen_
+{
+    int id;
+    int elemSize;
+    int depth;
+}ChannelOpen;
+
+/*
+ * @brief   Wait Graph Kernel Call Arguments
+ * @details Holds all variables passed to kernel
+ *          for when blocked processes are listed
+ */
+typedef struct WaitGraph_
+{
+    struct WaitGraphEntry_ * entries;
+    int maxEntries;
+    unsigned long minTicks;
+}WaitGraph;
+
+/*
+ * @brief   Trace Read Kernel Call Arguments
+ * @details Holds all variables passed to kernel
+ *          for when trace records are read back
+ */
+typedef struct TraceRead_
+{
+    struct TraceRecord_ * records;
+    int start;
+    int maxRecords;
+}TraceRead;
+
+/*
+ * @brief   Spawn Kernel Call Arguments
+ * @details Holds all variables passed to kernel
+ *          for when a process is started at run time
+ */
+typedef struct Spawn_
+{
+    void (*code)(void);
+    int priority;
+    int stackSize;
+}Spawn;
+
+/* Structures filled in by kernel calls, defined by the modules that own them */
+struct MailBoxStats_;
+struct DeadlockReport_;
+struct ProcessInfo_;
+struct MailBoxInfo_;
+struct PoolInfo_;
+struct TimerInfo_;
+struct HopStats_;
+
 #ifndef GLOBAL_KERNELCALL
 #define GLOBAL_KERNELCALL
 
@@ -59,7 +166,42 @@ extern int getid(void);
 extern int nice(unsigned int);
 extern void terminate(void);
 extern int sendMessage(int, int, void *, int);
+extern int sendPriorityMessage(int, int, void *, int, int);
 extern int recvMessage(int, int*, void *, int *);
+extern int recvPriorityMessage(int, int*, void *, int *, int *);
 extern void block(void);
+extern int recvBatch(int, MessageEntry *, int);
+extern int subscribe(int, int);
+extern int unsubscribe(int, int);
+extern int publish(int, int, void *, int);
+extern int registerName(char *, int);
+extern int lookupName(char *);
+extern int bindName(char *);
+extern int getMailBoxStats(int, struct MailBoxStats_ *);
+extern int waitAny(int *, int, unsigned long, unsigned long *);
+extern struct Channel_ * channelOpen(int, int, int);
+extern int channelWait(int, int);
+extern int channelSignal(int, int);
+extern int mutexLock(int);
+extern int mutexUnlock(int);
+extern int semInit(int, int);
+extern int semWait(int);
+extern int semSignal(int);
+extern int getWaitGraph(struct WaitGraphEntry_ *, int, unsigned long);
+extern int getDeadlockReport(struct DeadlockReport_ *);
+extern int getProcessList(struct ProcessInfo_ *, int);
+extern int getMailBoxList(struct MailBoxInfo_ *, int);
+extern void getPoolInfo(struct PoolInfo_ *);
+extern void getTimerInfo(struct TimerInfo_ *);
+extern int getTrace(struct TraceRecord_ *, int, int);
+extern unsigned int startCorrelation(void);
+extern void endCorrelation(void);
+extern int getHopStats(int, struct HopStats_ *);
+extern int spawn(void (*)(void), int, int);
+
+#else
+
+int sendPriorityMessage(int, int, void *, int, int);
+int recvPriorityMessage(unsigned int, int*, void *, int *, int *);
 
 #endif
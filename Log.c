@@ -0,0 +1,143 @@
+/*
+ * @file    Log.c
+ * @brief   Contains the log ring and its drain process. logWrite may be
+ *          called from processes, the kernel and ISRs; it only stores a
+ *          record. The drain process ships records on UART0 when
+ *          nothing more important is running.
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#include <string.h>
+#include "KernelCall.h"
+#include "SVC.h"
+#include "SYSTICK.h"
+#include "Utilities.h"
+#include "Clock.h"
+#include "UART.h"
+#define GLOBAL_LOG
+#include "Log.h"
+
+/* Records, indexed by logHead/logTail modulo LOG_DEPTH */
+static LogRecord logRing[LOG_DEPTH];
+static unsigned long logHead = 0;
+static unsigned long logTail = 0;
+
+/* Records lost to a full ring since the drain last ran */
+static unsigned int logDropped = 0;
+
+static const char hexDigits[] = "0123456789ABCDEF";
+
+/*
+ * @brief   Adds a record to the log ring. The drain process is woken
+ *          when the ring stops being empty.
+ * @param   [in] int id: one of logMessages
+ *          [in] unsigned int arg1: first format argument
+ *          [in] unsigned int arg2: second format argument
+ */
+void logWrite(int id, unsigned int arg1, unsigned int arg2)
+{
+    unsigned long mask = get_PRIMASK();
+    PCB * running;
+    LogRecord * record;
+
+    disable();
+    if((logHead - logTail) == LOG_DEPTH)
+    {
+        logDropped++;
+    }
+    else
+    {
+        running = getRunningPCB();
+        record = &logRing[logHead & (LOG_DEPTH - 1)];
+        record->ticks = getKernelTicks();
+        record->id = id;
+        record->pid = (running)? running->pid : 0;
+        record->arg1 = arg1;
+        record->arg2 = arg2;
+        if(logHead++ == logTail)
+        {
+            signalSource(SOURCE_LOG);
+        }
+    }
+    set_PRIMASK(mask);
+}
+
+/*
+ * @brief   Copies the oldest records out of the ring, reporting any
+ *          dropped since the last call as a LOG_DROPPED record first
+ * @param   [out] LogRecord* records: where the records are copied
+ *          [in] int max: number of records available
+ * @return  int: number of records copied
+ */
+static int logTake(LogRecord * records, int max)
+{
+    int count = 0;
+
+    disable();
+    if(logDropped)
+    {
+        records[count].ticks = getKernelTicks();
+        records[count].id = LOG_DROPPED;
+        records[count].pid = 0;
+        records[count].arg1 = logDropped;
+        records[count].arg2 = 0;
+        logDropped = 0;
+        count++;
+    }
+    while((count < max) && (logTail != logHead))
+    {
+        records[count++] = logRing[logTail & (LOG_DEPTH - 1)];
+        logTail++;
+    }
+    enable();
+
+    return count;
+}
+
+/*
+ * @brief   Low priority process that sends the log on UART0, one
+ *          record per APC string, and sleeps while the ring is empty.
+ *          A taken record is held until the output server has room for
+ *          it, so none are lost to a full pool.
+ */
+void logDrainProcess(void)
+{
+    int mailBox = bind(ANY);
+    LogRecord records[LOG_DRAIN_BATCH];
+    char apc[MESSAGE_SYS_LIMIT];
+    unsigned char * bytes;
+    unsigned long ready;
+    int count;
+    int length;
+    int i;
+    int j;
+
+    /* Logged here rather than from main so no source is signalled
+     * before the kernel is running
+     */
+    LOG(LOG_BOOT, getSystemClock() / CLOCK_MHZ, 0);
+
+    while(1)
+    {
+        count = logTake(records, LOG_DRAIN_BATCH);
+        if(!count)
+        {
+            waitAny(NULL, 0, SOURCE_LOG, &ready);
+        }
+
+        for(i = 0; i < count; i++)
+        {
+            strcpy(apc, LOG_APC_START);
+            length = strlen(LOG_APC_START);
+            bytes = (unsigned char *)&records[i];
+            for(j = 0; j < (int)sizeof(LogRecord); j++)
+            {
+                apc[length++] = hexDigits[bytes[j] >> 4];
+                apc[length++] = hexDigits[bytes[j] & 0xF];
+            }
+            strcpy(&apc[length], LOG_APC_END);
+            sendApc(mailBox, apc);
+        }
+    }
+}
@@ -0,0 +1,62 @@
+/*
+ * @file    Log.h
+ * @brief   Contains the deferred formatting log. A LOG call records the
+ *          id of its format string and two raw arguments; the strings
+ *          never leave the firmware. Records are shipped on UART0 by a
+ *          low priority drain process and expanded on the host by
+ *          tools/logdecode.py, which reads the table below.
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#pragma once
+
+/* Log messages in id order. Formats take at most two %u/%d/%x
+ * arguments; new messages go on the end so older captures still decode.
+ */
+#define LOG_MESSAGES(X) \
+    X(LOG_DROPPED,          "%u records dropped, ring full") \
+    X(LOG_BOOT,             "kernel started, clock %u MHz") \
+    X(LOG_SPAWN,            "spawned pid %u at priority %u") \
+    X(LOG_TERMINATE,        "pid %u terminated") \
+    X(LOG_RETRANSMIT,       "retransmitting frame %u, next is %u") \
+    X(LOG_NACK_SENT,        "NACK, frame %u arrived expecting %u") \
+    X(LOG_CHECKSUM_FAIL,    "bad checksum on %u byte frame, got %02x") \
+    X(LOG_FRAME_OVERRUN,    "UART1 frame lost, %u frames waiting")
+
+#define LOG_ENUM(id, format) id,
+enum logMessages {LOG_MESSAGES(LOG_ENUM) LOG_AMOUNT};
+
+/* Number of records held, a power of two. Records logged while the
+ * ring is full are counted and reported as LOG_DROPPED
+ */
+#define LOG_DEPTH       128
+
+/* Records the drain process takes out of the ring at once */
+#define LOG_DRAIN_BATCH 8
+
+/* Each record is sent on UART0 as hex inside an APC string */
+#define LOG_APC_START   "\x1b_L"
+#define LOG_APC_END     "\x1b\\"
+
+/* Structure of a log record, 8 bytes in little endian order */
+typedef struct LogRecord_
+{
+    /* Low 16 bits of the kernel tick count */
+    unsigned short ticks;
+    unsigned char id;
+    unsigned char pid;
+    unsigned short arg1;
+    unsigned short arg2;
+
+}LogRecord;
+
+#define LOG(id, arg1, arg2) logWrite((id), (arg1), (arg2))
+
+#ifndef GLOBAL_LOG
+#define GLOBAL_LOG
+
+extern void logWrite(int, unsigned int, unsigned int);
+extern void logDrainProcess(void);
+
+#endif /* GLOBAL_LOG */
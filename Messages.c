@@ -13,11 +13,16 @@
 
 #include "SVC.h"
 #include "KernelCall.h"
+#include "SYSTICK.h"
+#include "Deadlock.h"
+#include "Trace.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define GLOBAL_MESSAGES
 #include "Messages.h"
+#include "Correlation.h"
 
 #define  NEXT i+1
 #define  PREV i-1
@@ -26,14 +31,50 @@
 /*Pointer to the head of the message pool*/
 static Message * messagePool = NULL;
 
+/*Pointer to the head of the message payload pool*/
+static MessageBuffer * bufferPool = NULL;
+
+/*Freed message payloads not yet zeroed by the idle scrub hook*/
+static MessageBuffer * dirtyBufferPool = NULL;
+
+/*Mailboxes subscribed to each topic*/
+static Topic topicList[TOPIC_AMOUNT];
+
 /*Mailbox List*/
 static MailBox mailboxList[MAILBOX_AMOUNT];
 
+/*Registry of named mailbox handles*/
+static MailBoxName nameList[MB_NAME_AMOUNT];
+
 /*free Mail Box pointer used for bind any*/
 static MailBox * freeMailBox;
 
 static ReceiveLog * receiveLogPool = NULL;
 
+/*Free, total and low water counts of each pool*/
+static PoolInfo poolCounts;
+
+/*
+ * @brief   Counts an entry returned to a pool
+ * @param   [in/out] PoolCount * pool: counts of the pool
+ */
+static void poolReturned(PoolCount * pool)
+{
+    pool->free++;
+}
+
+/*
+ * @brief   Counts an entry taken from a pool
+ * @param   [in/out] PoolCount * pool: counts of the pool
+ */
+static void poolTaken(PoolCount * pool)
+{
+    if(--(pool->free) < pool->lowWater)
+    {
+        pool->lowWater = pool->free;
+    }
+}
+
 /*
  * @brief   Initializes the doubly linked list connecting unowned
  *          mailboxs allowing bind any in constant time
@@ -42,6 +83,18 @@ void initMailBoxList(void)
 {
     int i;
 
+    // every name entry starts out free
+    for(i = 0; i < MB_NAME_AMOUNT; i++)
+    {
+        nameList[i].handle = ANY;
+    }
+
+    for(i = 0; i < MAILBOX_AMOUNT; i++)
+    {
+        mailboxList[i].generation = 1;
+    }
+
+    i = STARTING_INDEX;
     mailboxList[i].index = i;
 
     //initialize free to mailbox at starting index
@@ -74,7 +127,42 @@ void initMailBoxList(void)
  */
 PCB * getOwnerPCB(int MB)
 {
-    return (PCB *)mailboxList[MB].owner;
+    MB = resolveMailBox(MB);
+    return (MB == FAILURE)? NULL : (PCB *)mailboxList[MB].owner;
+}
+
+/*
+ * @brief   Returns the process that last sent to a mailbox
+ * @param   [in] int mailbox: index of the mailbox
+ * @return  PCB *: PCB of the sender, NULL if nothing was sent since binding
+ */
+PCB * getLastSender(int mailbox)
+{
+    return (STARTING_INDEX <= mailbox && mailbox < MAILBOX_AMOUNT)?
+            mailboxList[mailbox].lastSender : NULL;
+}
+
+/*
+ * @brief   Converts a mailbox handle into its mailbox list index.
+ *          Handles without a generation (well-known MB #s) are always
+ *          accepted; any other handle must carry the mailbox's current
+ *          generation.
+ * @param   [in] int handle: MB # or handle returned by bind any
+ * @return  int: index of the mailbox, -1 if the handle is invalid or stale
+ */
+int resolveMailBox(int handle)
+{
+    int index = MB_INDEX(handle);
+    int generation = MB_GENERATION(handle);
+
+    if((handle < STARTING_INDEX) || (index >= MAILBOX_AMOUNT) ||
+       (handle != MB_HANDLE(index, generation)))
+    {return FAILURE;}
+
+    if(generation && (generation != mailboxList[index].generation))
+    {return FAILURE;}
+
+    return index;
 }
 
 /*
@@ -86,9 +174,10 @@ void addToPool(Message * newMsg)
 {
     newMsg->from =NULL;
     newMsg->size= NULL;
-    *(newMsg->contents)=NULL;
+    newMsg->buffer = NULL;
     newMsg->next = messagePool;
     messagePool = newMsg;
+    poolReturned(&poolCounts.messages);
 }
 
 /*
@@ -100,20 +189,82 @@ Message * retrieveFromPool(void)
     Message * newPtr = messagePool;
     // Fault protection
     messagePool = (newPtr) ? newPtr->next : NULL;
+    if(newPtr)
+    {
+        poolTaken(&poolCounts.messages);
+    }
     return newPtr;
 }
 
 /*
- * @brief   Initializes the linked list connecting the
- *          free message structures
+ * @brief   To return a message payload to the pool
+ * @param   [in/out]  MessageBuffer * newBuffer: address of payload
+ *          being returned to the pool
+ */
+void addBufferToPool(MessageBuffer * newBuffer)
+{
+    newBuffer->refCount = 0;
+    newBuffer->next = dirtyBufferPool;
+    dirtyBufferPool = newBuffer;
+    poolReturned(&poolCounts.buffers);
+}
+
+/*
+ * @brief   To retrieve a message payload from the pool
+ * @return  MessageBuffer *: address of payload retrieved
+ */
+MessageBuffer * retrieveBufferFromPool(void)
+{
+    MessageBuffer * newPtr = bufferPool;
+
+    // Zeroed payloads are handed out first
+    if(newPtr)
+    {
+        bufferPool = newPtr->next;
+    }
+    else if((newPtr = dirtyBufferPool))
+    {
+        dirtyBufferPool = newPtr->next;
+    }
+
+    if(newPtr)
+    {
+        poolTaken(&poolCounts.buffers);
+    }
+    return newPtr;
+}
+
+/*
+ * @brief   Returns a received message to the pool, along with its
+ *          payload once no other queued message refers to it
+ * @param   [in/out]  Message * oldMsg: message that has been copied out
+ */
+void releaseMessage(Message * oldMsg)
+{
+    if(oldMsg->buffer && (--(oldMsg->buffer->refCount) <= 0))
+    {
+        addBufferToPool(oldMsg->buffer);
+    }
+    addToPool(oldMsg);
+}
+
+/*
+ * @brief   Initializes the linked lists connecting the
+ *          free message structures and payloads
  */
 void initMessagePool(void)
 {
     int i;
-    for(i=0;i<MESSAGE_SYS_LIMIT;i++)
+    for(i=0;i<MESSAGE_HEADER_AMOUNT;i++)
     {
         addToPool(malloc(sizeof(Message)));
     }
+    for(i=0;i<MESSAGE_BUFFER_AMOUNT;i++)
+    {
+        addBufferToPool(malloc(sizeof(MessageBuffer)));
+    }
+    poolCounts.messages.total = poolCounts.messages.lowWater = poolCounts.messages.free;
+    poolCounts.buffers.total = poolCounts.buffers.lowWater = poolCounts.buffers.free;
 }
 
 /*
@@ -126,6 +277,7 @@ void addReceiveLog(ReceiveLog * newLog)
     newLog->mailbox =NULL;
     newLog->next = receiveLogPool;
     receiveLogPool = newLog;
+    poolReturned(&poolCounts.logs);
 }
 
 /*
@@ -137,6 +289,10 @@ ReceiveLog * retrieveReceiveLog(void)
     ReceiveLog * newPtr = receiveLogPool;
     // Fault protection
     receiveLogPool = (newPtr) ? newPtr->next : NULL;
+    if(newPtr)
+    {
+        poolTaken(&poolCounts.logs);
+    }
     return newPtr;
 }
 
@@ -151,35 +307,54 @@ void initReceiveLogs(void)
     {
         addReceiveLog(malloc(sizeof(ReceiveLog)));
     }
+    poolCounts.logs.total = poolCounts.logs.lowWater = poolCounts.logs.free;
 }
 
+/*
+ * @brief   Appends a receive log to the tail of a PCB's receive any list
+ * @param   [in/out] PCB* owner: PCB of the mailbox owner
+ *          [in/out] ReceiveLog* newLog: log being appended
+ */
 void addReceiveLogToPCB(PCB* owner, ReceiveLog* newLog)
 {
-    if(owner->receiveAnyHead)
-    {
-        ReceiveLog * temp = owner->receiveAnyTail;
-        owner->receiveAnyTail = newLog;
-        owner->receiveAnyTail->next = NULL;
+    newLog->next = NULL;
+    newLog->prev = owner->receiveAnyTail;
 
-        if (temp)
-        {
-            temp->next = owner->receiveAnyTail;
-            owner->receiveAnyTail->prev = temp;
-        }
-        else
-        {
-            owner->receiveAnyTail->prev = owner->receiveAnyHead;
-        }
+    if(owner->receiveAnyTail)
+    {
+        owner->receiveAnyTail->next = newLog;
     }
     else
     {
+        //first message held by this PCB
+        owner->receiveAnyHead = newLog;
+    }
+    owner->receiveAnyTail = newLog;
+}
 
-        //first message in mailbox
+/*
+ * @brief   Unlinks a receive log from anywhere in a PCB's receive any list
+ * @param   [in/out] PCB* owner: PCB of the mailbox owner
+ *          [in/out] ReceiveLog* oldLog: log being removed
+ */
+void removeReceiveLogFromPCB(PCB* owner, ReceiveLog* oldLog)
+{
+    if(oldLog->prev)
+    {
+        oldLog->prev->next = oldLog->next;
+    }
+    else
+    {
+        owner->receiveAnyHead = oldLog->next;
+    }
 
-        owner->receiveAnyHead = newLog;
-        owner->receiveAnyTail = NULL;
-        owner->receiveAnyHead->next = owner->receiveAnyTail;
-        owner->receiveAnyHead->prev = NULL;
+    if(oldLog->next)
+    {
+        oldLog->next->prev = oldLog->prev;
+    }
+    else
+    {
+        owner->receiveAnyTail = oldLog->prev;
     }
 }
 
@@ -193,21 +368,199 @@ int getOldestMessageMB(PCB* owner)
     return toReturn;
 }
 
+/*
+ * @brief   Empties the message and receive log lists of a mailbox
+ * @param   [in] int mailbox: index of the mailbox
+ */
+void resetMailBox(int mailbox)
+{
+    int i;
+    for(i = 0; i < MESSAGE_PRIORITIES; i++)
+    {
+        mailboxList[mailbox].head[i] = mailboxList[mailbox].tail[i] = NULL;
+    }
+    mailboxList[mailbox].oldest = mailboxList[mailbox].newest = NULL;
+
+    // statistics only cover the current binding
+    memset(&mailboxList[mailbox].stats, NUL, sizeof(MailBoxStats));
+    mailboxList[mailbox].lastSender = NULL;
+}
+
+/*
+ * @brief   Finds the latency histogram bucket of a delay
+ * @param   [in] unsigned long elapsed: delay in SysTick clock cycles
+ * @return  int: bucket index, 0 to LATENCY_BUCKETS - 1
+ */
+int latencyBucket(unsigned long elapsed)
+{
+    int bucket = 0;
+
+    elapsed >>= LATENCY_SHIFT;
+    while(elapsed && (bucket < LATENCY_BUCKETS - 1))
+    {
+        elapsed >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+/*
+ * @brief   Adds a queueing delay to a mailbox's latency histogram
+ * @param   [in/out] MailBoxStats * stats: statistics of the mailbox
+ *          [in] unsigned long elapsed: SysTick clock cycles spent queued
+ */
+void recordLatency(MailBoxStats * stats, unsigned long elapsed)
+{
+    stats->latency[latencyBucket(elapsed)]++;
+}
+
+/*
+ * @brief   Counts a refused send against its destination mailbox
+ * @param   [in] int mailbox: index of the destination, -1 if it was invalid
+ * @return  int: -2 so callers can return the result directly
+ */
+int sendFailed(int mailbox)
+{
+    if(mailbox != FAILURE)
+    {
+        mailboxList[mailbox].stats.failedSends++;
+    }
+    return SEND_FAIL;
+}
+
+/*
+ * @brief   Counts a message handed straight to a blocked receiver, which
+ *          never waits in the mailbox, and hands the receiver the
+ *          sender's correlation
+ * @param   [in] int mailbox: index of the destination mailbox
+ */
+void recordDirectDelivery(int mailbox)
+{
+    MailBoxStats * stats = &mailboxList[mailbox].stats;
+    PCB * sender = getRunningPCB();
+    stats->sends++;
+    stats->receives++;
+    stats->latency[0]++;
+    adoptCorrelation(mailboxList[mailbox].owner, sender->correlation,
+                     sender->correlationStamp, mailbox);
+}
+
+/*
+ * @brief   Checks whether a mailbox holds a message of any priority
+ * @param   [in] int mailbox: index of the mailbox
+ * @return  int: TRUE if a message is queued, FALSE otherwise
+ */
+int hasMessage(int mailbox)
+{
+    return (mailboxList[mailbox].oldest)? TRUE : FALSE;
+}
+
+/*
+ * @brief   Links a message onto the tail of its priority sub-queue and
+ *          records a receive log for it so receive any can find it
+ * @param   [in] int mailbox: index of the destination mailbox
+ *          [in/out] Message * newMessage: message being queued
+ *          [in/out] ReceiveLog * newRecv: log tracking the message
+ */
+void enqueueMessage(int mailbox, Message * newMessage, ReceiveLog * newRecv)
+{
+    MailBox * box = &mailboxList[mailbox];
+    int priority = newMessage->priority;
+
+    newMessage->next = NULL;
+    if(box->tail[priority])
+    {
+        box->tail[priority]->next = newMessage;
+    }
+    else
+    {
+        //first message in this sub-queue
+        box->head[priority] = newMessage;
+    }
+    box->tail[priority] = newMessage;
+
+    newMessage->enqueueTime = getKernelTime();
+    box->stats.sends++;
+    if(++(box->stats.depth) > box->stats.peakDepth)
+    {
+        box->stats.peakDepth = box->stats.depth;
+    }
+
+    newRecv->mailbox = mailbox;
+    newRecv->myNext = NULL;
+    if(box->newest)
+    {
+        box->newest->myNext = newRecv;
+    }
+    else
+    {
+        box->oldest = newRecv;
+    }
+    box->newest = newRecv;
+
+    addReceiveLogToPCB(box->owner, newRecv);
+}
+
+/*
+ * @brief   Unlinks the oldest message of the highest occupied priority from
+ *          a mailbox and returns a receive log to the pool. Logs only count
+ *          the messages held by a mailbox, so the mailbox's oldest log is
+ *          the one released. The caller must return the message to the pool
+ *          once its contents have been copied out.
+ * @param   [in] int mailbox: index of a mailbox holding at least one message
+ * @return  Message *: address of the message removed
+ */
+Message * dequeueMessage(int mailbox)
+{
+    MailBox * box = &mailboxList[mailbox];
+    int priority = MESSAGE_PRIORITIES - 1;
+    ReceiveLog * oldLog = box->oldest;
+
+    while(!box->head[priority])
+    {
+        priority--;
+    }
+
+    Message * oldMessage = box->head[priority];
+    box->head[priority] = oldMessage->next;
+    if(!box->head[priority])
+    {
+        box->tail[priority] = NULL;
+    }
+
+    box->oldest = oldLog->myNext;
+    if(!box->oldest)
+    {
+        box->newest = NULL;
+    }
+
+    removeReceiveLogFromPCB(box->owner, oldLog);
+    addReceiveLog(oldLog);
+
+    box->stats.depth--;
+    box->stats.receives++;
+    recordLatency(&box->stats, getKernelTime() - oldMessage->enqueueTime);
+    adoptCorrelation(box->owner, oldMessage->correlation, oldMessage->correlationStamp, mailbox);
+
+    return oldMessage;
+}
+
 /*
  * @brief   Allow processes to bind to a mailbox
  * @param   int desiredMB: Mailbox that the process
- *          wants to bind to. If desiredMB == 16
+ *          wants to bind to. If desiredMB == ANY
  *          it will bind to the MB pointed to by
  *          freeMailBox
- * @return  Bind Fail = -4 or Mailbox Number that
- *          was binded to
+ * @return  Bind Fail = -4, Success = 1 for a specific
+ *          mailbox or the handle of the mailbox bound
+ *          by bind any
  *
  * */
 int kernelBind(int desiredMB)
 {
     int result = SUCCESS;
 
-    if(!(STARTING_INDEX<=desiredMB&&desiredMB<=MAILBOX_AMOUNT))
+    if(!(STARTING_INDEX<=desiredMB&&desiredMB<MAILBOX_AMOUNT) && (desiredMB != ANY))
     {return BIND_FAIL;}
 
     if(desiredMB == ANY)
@@ -222,8 +575,8 @@ int kernelBind(int desiredMB)
             freeMailBox = (freeMailBox->nextFree==freeMailBox)? NULL : freeMailBox->nextFree;
 
             mailboxList[desiredMB].owner = (struct ProcessControlBlock_*)getRunningPCB();
-            mailboxList[desiredMB].head = mailboxList[desiredMB].tail = NULL;
-            result = desiredMB;
+            resetMailBox(desiredMB);
+            result = MB_HANDLE(desiredMB, mailboxList[desiredMB].generation);
         }
         else
         {
@@ -239,9 +592,9 @@ int kernelBind(int desiredMB)
             mailboxList[desiredMB].owner = (struct ProcessControlBlock_*)getRunningPCB();
             mailboxList[desiredMB].prevFree->nextFree = mailboxList[desiredMB].nextFree;
             mailboxList[desiredMB].nextFree->prevFree = mailboxList[desiredMB].prevFree;
-            mailboxList[desiredMB].head =mailboxList[desiredMB].tail = NULL;
+            resetMailBox(desiredMB);
 
-            if(desiredMB==freeMailBox->index)
+            if(freeMailBox && (desiredMB==freeMailBox->index))
             {
                 freeMailBox = (freeMailBox->nextFree==freeMailBox)? NULL : freeMailBox->nextFree;
             }
@@ -251,35 +604,183 @@ int kernelBind(int desiredMB)
             result = BIND_FAIL;
         }
     }
+
+    if(result != BIND_FAIL)
+    {
+        TRACE(TRACE_BIND, desiredMB);
+    }
     return result;
 }
 
 /*
  * @brief   Allow processes to unbind from a mailbox
- * @param   int releasedMB: Mailbox number the process
- *          wants to release
+ * @param   int releasedMB: Mailbox number or handle the
+ *          process wants to release
  * @return  Unbind Fail = -5 or Success = 1
  *
  * */
 int kernelUnbind(int releaseMB)
 {
     int result = UNBIND_FAIL;
+    int topic;
 
-    if(mailboxList[releaseMB].owner == getRunningPCB()||!(STARTING_INDEX<=releaseMB&&releaseMB<=MAILBOX_AMOUNT))
+    releaseMB = resolveMailBox(releaseMB);
+
+    if((releaseMB != FAILURE) && (mailboxList[releaseMB].owner == getRunningPCB()))
     {
+        // Queued messages and subscriptions go with the binding
+        while(hasMessage(releaseMB))
+        {
+            releaseMessage(dequeueMessage(releaseMB));
+        }
+        for(topic = STARTING_INDEX; topic < TOPIC_AMOUNT; topic++)
+        {
+            kernelUnsubscribe(topic, releaseMB);
+        }
+
         mailboxList[releaseMB].owner = NULL;
 
+        // Invalidate outstanding handles and names of this mailbox
+        mailboxList[releaseMB].generation = (mailboxList[releaseMB].generation % MB_GENERATION_MASK) + 1;
+        removeNames(releaseMB);
+
         mailboxList[releaseMB].nextFree = (freeMailBox)? freeMailBox : &mailboxList[releaseMB];
         mailboxList[releaseMB].prevFree = (freeMailBox)? freeMailBox->prevFree : &mailboxList[releaseMB];
 
         freeMailBox = &mailboxList[releaseMB];
         freeMailBox->nextFree->prevFree =  &mailboxList[releaseMB];
+        freeMailBox->prevFree->nextFree =  &mailboxList[releaseMB];
 
         return SUCCESS;
     }
     return result;
 }
 
+/*
+ * @brief   Hands a message straight to a mailbox owner that is blocked
+ *          in a receive and puts it back in its waitingToRun queue
+ * @param   [in/out] PCB * owner: blocked PCB of the destination mailbox
+ *          [in] int fromMB: MB # of the sending process
+ *          [in] void* contents: data to be sent
+ *          [in] int size: amount of data measured in bytes
+ *          [in] int priority: priority the message was sent with
+ */
+void deliverToBlocked(PCB * owner, int fromMB, void * contents, int size, int priority)
+{
+    *(owner->from) = fromMB;
+    memset(owner->contents, NUL, owner->size);
+    int copySize = (owner->size < size)? owner->size : size;
+    memcpy(owner->contents, contents, copySize);
+    owner->size = copySize;
+    owner->blockState = READY;
+    owner->waitMB = ANY;
+    addPCB(owner, owner->priority);
+
+    if(owner->msgPriority)
+    {
+        *(owner->msgPriority) = priority;
+        owner->msgPriority = NULL;
+    }
+
+    if(owner->batch)
+    {
+        /* A batch receive gets a batch of one */
+        owner->batch->size = copySize;
+        owner->batch->priority = priority;
+        *(owner->returnValue) = 1;
+        owner->batch = NULL;
+    }
+    else
+    {
+        *(owner->returnValue) = copySize;
+    }
+    owner->contents = NULL;
+}
+
+/*
+ * @brief   Checks whether a mailbox owner is blocked in a receive that
+ *          takes messages from a mailbox
+ * @param   [in] PCB * owner: PCB of the mailbox owner
+ *          [in] int mailbox: index of the mailbox
+ * @return  int: TRUE if a message can be handed over directly
+ */
+int isReceiving(PCB * owner, int mailbox)
+{
+    return ((owner->blockState == RECV_BLOCKED) &&
+            ((owner->waitMB == ANY) || (owner->waitMB == mailbox)))? TRUE : FALSE;
+}
+
+/*
+ * @brief   Wakes a mailbox owner blocked in waitAny if the mailbox is one
+ *          of those it waits on, handing back the handle it waited with
+ * @param   [in] int mailbox: index of the mailbox a message was queued in
+ */
+void wakeMailBoxWaiter(int mailbox)
+{
+    int i;
+    PCB * owner = mailboxList[mailbox].owner;
+
+    if(owner->blockState != WAIT_BLOCKED)
+    {return;}
+
+    for(i = 0; i < owner->waitCount; i++)
+    {
+        if(resolveMailBox(owner->waitMailboxes[i]) == mailbox)
+        {
+            *(owner->returnValue) = owner->waitMailboxes[i];
+            wakeWaiter(owner);
+            return;
+        }
+    }
+}
+
+/*
+ * @brief   Queues a message referring to an already filled payload in a
+ *          mailbox, taking a reference on the payload. Small messages
+ *          are instead copied into the message structure's inline slot.
+ * @param   [in] int destinationMB: MB # of the destination process
+ *          [in] int fromMB: MB # of the sending process
+ *          [in/out] MessageBuffer * buffer: payload of the message, NULL
+ *                                           to hold contents inline
+ *          [in] void* contents: data of a message held inline
+ *          [in] int size: amount of data measured in bytes
+ *          [in] int priority: priority sub-queue the message is placed in
+ * @return  int: 1->success, -2->no message structure was available
+ */
+int queueMessage(int destinationMB, int fromMB, MessageBuffer * buffer, void * contents,
+                 int size, int priority)
+{
+    Message * newMessage = retrieveFromPool();
+    ReceiveLog * newRecv = (newMessage)? retrieveReceiveLog() : NULL;
+
+    if(!newRecv)
+    {
+        if(newMessage)
+        {
+            addToPool(newMessage);
+        }
+        return SEND_FAIL;
+    }
+
+    newMessage->from = fromMB;
+    newMessage->size = size;
+    newMessage->priority = priority;
+    newMessage->buffer = buffer;
+    newMessage->correlation = getRunningPCB()->correlation;
+    newMessage->correlationStamp = getRunningPCB()->correlationStamp;
+    if(buffer)
+    {
+        buffer->refCount++;
+    }
+    else
+    {
+        memcpy(newMessage->inlineContents, contents, size);
+    }
+    enqueueMessage(destinationMB, newMessage, newRecv);
+    wakeMailBoxWaiter(destinationMB);
+    return SUCCESS;
+}
+
 /*
  * @brief   Adds message to a mailbox, if destination process is blocked; it transfers message
  *          and unblocks
@@ -287,86 +788,105 @@ int kernelUnbind(int releaseMB)
  *          [in] int fromMB: MB # of the sending process
  *          [in] void* contents: data to be sent
  *          [in] int size: amount of data measured in bytes
+ *          [in] int priority: priority sub-queue the message is placed in
  * @return  int: 1->success, -1->failure
  */
-int kernelSend(int destinationMB, int fromMB, void * contents, int size)
+int kernelSend(int destinationMB, int fromMB, void * contents, int size, int priority)
 {
    PCB * runningPCB = (struct ProcessControlBlock_*) getRunningPCB();
+   int fromIndex = resolveMailBox(fromMB);
+
+   destinationMB = resolveMailBox(destinationMB);
 
    //check the validity of arguments
-   if((mailboxList[fromMB].owner != runningPCB)||
+   if((fromIndex == FAILURE)||(destinationMB == FAILURE)||
+      (mailboxList[fromIndex].owner != runningPCB)||
       (!(mailboxList[destinationMB].owner))||
       (MESSAGE_SYS_LIMIT<size))
-   {return SEND_FAIL;}
+   {return sendFailed(destinationMB);}
 
-   //check if the destination process is blocked
-   if(mailboxList[destinationMB].owner->contents)
+   mailboxList[destinationMB].lastSender = runningPCB;
+   TRACE(TRACE_SEND, destinationMB);
+
+   //check if the destination process is blocked receiving from this mailbox
+   if(isReceiving(mailboxList[destinationMB].owner, destinationMB))
    {
        /* If the owner's PCB is blocked*/
-
-     *(mailboxList[destinationMB].owner->from) = fromMB;
-     memset(mailboxList[destinationMB].owner->contents, NUL, mailboxList[destinationMB].owner->size);
-     int copySize = (mailboxList[destinationMB].owner->size< size)?
-                     mailboxList[destinationMB].owner->size :
-                     size;
-      memcpy(mailboxList[destinationMB].owner->contents, contents, copySize);
-      mailboxList[destinationMB].owner->size = copySize;
-      addPCB(mailboxList[destinationMB].owner, mailboxList[destinationMB].owner->priority);
-      *(mailboxList[destinationMB].owner->returnValue) = copySize;
-      mailboxList[destinationMB].owner->contents = NULL;
-
+       deliverToBlocked(mailboxList[destinationMB].owner, fromMB, contents, size, priority);
+       recordDirectDelivery(destinationMB);
+   }
+   else if(size <= SMALL_MESSAGE_LIMIT)
+   {
+       //small messages are carried inline and never take a pool payload
+       if(queueMessage(destinationMB, fromMB, NULL, contents, size, priority) == SEND_FAIL)
+       { return sendFailed(destinationMB);}
    }
    else
    {
        //if not blocked, fill a message structure mailbox the
        //message pool and put it in the mailbox
-       ReceiveLog * newRecv = retrieveReceiveLog();
-       Message * newMessage = retrieveFromPool();
+       MessageBuffer * newBuffer = retrieveBufferFromPool();
 
-       if(newMessage)
+       if(!newBuffer)
+       { return sendFailed(destinationMB);}
+
+       memcpy(newBuffer->contents, contents, size);
+       if(queueMessage(destinationMB, fromMB, newBuffer, NULL, size, priority) == SEND_FAIL)
        {
-           newRecv->mailbox = destinationMB;
-           newMessage->from = fromMB;
-           newMessage->size = size;
-           memcpy(newMessage->contents, contents, size);
-           if(mailboxList[destinationMB].head)
-           {
-               ReceiveLog * tempLog = mailboxList[destinationMB].newest;
-               mailboxList[destinationMB].newest= newRecv;
-               mailboxList[destinationMB].newest->myNext = NULL;
-               if (tempLog)
-               {
-                    tempLog->myNext = mailboxList[destinationMB].newest;
-               }
-
-               Message * temp = mailboxList[destinationMB].tail;
-               mailboxList[destinationMB].tail = newMessage;
-               mailboxList[destinationMB].tail->next = NULL;
-               if(temp)
-               {
-                   temp->next = mailboxList[destinationMB].tail;
-               }
-           }
-           else
-           {
-
-               //first message in mailbox
-
-               mailboxList[destinationMB].oldest = newRecv;
-               mailboxList[destinationMB].oldest->myNext = mailboxList[destinationMB].newest;
-
-               mailboxList[destinationMB].head = newMessage;
-               mailboxList[destinationMB].tail=NULL;
-               mailboxList[destinationMB].head->next = mailboxList[destinationMB].tail;
-           }
-           addReceiveLogToPCB(mailboxList[destinationMB].owner, newRecv);
+           addBufferToPool(newBuffer);
+           return sendFailed(destinationMB);
        }
-       else{ return SEND_FAIL;}
 
    }
    return SUCCESS;
 }
 
+/*
+ * @brief   Unbinds every mailbox of a terminating process and forgets it
+ *          as the last sender to any mailbox
+ * @param   [in] PCB * owner: PCB of the terminating process, still RUNNING
+ */
+void releaseMailBoxes(PCB * owner)
+{
+    int i;
+
+    for(i = STARTING_INDEX; i < MAILBOX_AMOUNT; i++)
+    {
+        if(mailboxList[i].owner == owner)
+        {
+            kernelUnbind(i);
+        }
+        if(mailboxList[i].lastSender == owner)
+        {
+            mailboxList[i].lastSender = NULL;
+        }
+    }
+}
+
+/*
+ * @brief   Saves the running process' receive arguments in its PCB
+ *          and removes it from its waitingToRun queue, switching the
+ *          PSP to the next process to run
+ * @param   [in] int mailbox: index of the mailbox received from, ANY for all
+ *          [out] int* returnMB: where the sender's MB # will be written
+ *          [in/out] void* contents: where the message will be copied
+ *          [in] int size: maximum amount of bytes the process will take
+ *          [out] int* returnValue: where the receive's result will be written
+ */
+void blockReceiver(int mailbox, int* returnMB, void * contents, int size, int * returnValue)
+{
+    PCB * runningPCB = blockPCB(RECV_BLOCKED);
+    runningPCB->waitMB = mailbox;
+    runningPCB->from = returnMB;
+    runningPCB->contents = contents;
+    runningPCB->size = size;
+    runningPCB->returnValue = returnValue;
+    checkWaitChain(runningPCB);
+    runningPCB->sp = get_PSP();
+    runningPCB = (struct ProcessControlBlock_*) getRunningPCB();
+    set_PSP(runningPCB->sp);
+}
+
 /*
  * @brief   Take message from a mailbox, blocks if mailbox is empty
  *          and unblocks
@@ -375,85 +895,457 @@ int kernelSend(int destinationMB, int fromMB, void * contents, int size)
  *          [in/out] void* contents: address where data is stored
  *          [in/out] int* maxSize: [in]maximum amount of bytes the process will take
  *                                 [out] amount of bytes that were copied
+ *          [out] int* priority: priority of the message received; may be NULL
  * @return  int: -1->failure, 1->success
  */
-int kernelReceive(int bindedMB, int* returnMB, void * contents, int * maxSize)
+int kernelReceive(int bindedMB, int* returnMB, void * contents, int * maxSize, int * priority)
 {
-    int result;
     PCB * runningPCB = (struct ProcessControlBlock_*) getRunningPCB();
 
     if(bindedMB == ANY)
     {
         bindedMB = getOldestMessageMB(runningPCB);
     }
+    else if((bindedMB = resolveMailBox(bindedMB)) == FAILURE)
+    {
+        return RECV_FAIL;
+    }
 
     if(bindedMB!=ANY)
     {
         if ((mailboxList[bindedMB].owner != runningPCB)
-                || !(STARTING_INDEX <= bindedMB && bindedMB < MAILBOX_AMOUNT)
                 || (MESSAGE_SYS_LIMIT < *maxSize))
         {return RECV_FAIL;}
 
 
-        if (mailboxList[bindedMB].head)
+        if (hasMessage(bindedMB))
         {
             // Mailbox contains at least one message
+            Message * temp = dequeueMessage(bindedMB);
 
-            if( runningPCB->receiveAnyHead == mailboxList[bindedMB].oldest)
-            {
-                runningPCB->receiveAnyHead = runningPCB->receiveAnyHead->next;
+            *returnMB = temp->from;
 
-                if(runningPCB->receiveAnyHead)
-                {
-                    runningPCB->receiveAnyHead->prev = NULL;
-                }
-            }
-            else if(runningPCB->receiveAnyTail == mailboxList[bindedMB].oldest)
-            {
-                if(runningPCB->receiveAnyTail->prev == runningPCB->receiveAnyHead)
-                {
-                    runningPCB->receiveAnyTail=NULL;
-                }
-                else
-                {
-                    runningPCB->receiveAnyTail = runningPCB->receiveAnyTail->prev;
-                    runningPCB->receiveAnyTail->next=NULL;
-                }
+            int copySize = (temp->size < *maxSize) ? temp->size : *maxSize;
 
-            }
-            else
+            memcpy(contents, MESSAGE_CONTENTS(temp), copySize);
+            *maxSize = copySize;
+            if(priority)
             {
-                mailboxList[bindedMB].oldest->next->prev =mailboxList[bindedMB].oldest->prev;
-                mailboxList[bindedMB].oldest->prev->next = mailboxList[bindedMB].oldest->next;
+                *priority = temp->priority;
             }
+            releaseMessage(temp);
+            TRACE(TRACE_RECEIVE, bindedMB);
+            return SUCCESS;
+        }
+    }
+    // BLOCK
+    runningPCB->msgPriority = priority;
+    blockReceiver(bindedMB, returnMB, contents, *maxSize, maxSize);
 
-            mailboxList[bindedMB].oldest = mailboxList[bindedMB].oldest->myNext;
+    *maxSize = getRunningPCB()->size;
+    return SUCCESS;
+}
 
-            *returnMB = mailboxList[bindedMB].head->from;
+/*
+ * @brief   Takes every message queued in a mailbox, up to maxEntries, in a
+ *          single kernel call. Blocks if the mailbox is empty; the next
+ *          message sent to the process is then handed back as a batch of one.
+ * @param   [in] int bindedMB: MB # of the receiving process
+ *          [out] MessageEntry* entries: where each sender, size and contents
+ *                                       is stored
+ *          [in] int maxEntries: number of entries available
+ *          [out] int* returnValue: where the count is written once a blocked
+ *                                  process is handed a message
+ * @return  int: -3->failure, otherwise number of messages received
+ */
+int kernelReceiveBatch(int bindedMB, MessageEntry * entries, int maxEntries, int * returnValue)
+{
+    int count = 0;
+    PCB * runningPCB = (struct ProcessControlBlock_*) getRunningPCB();
 
-            int copySize =
-                    (mailboxList[bindedMB].head->size < *maxSize) ?
-                            mailboxList[bindedMB].head->size : *maxSize;
+    if(bindedMB == ANY)
+    {
+        bindedMB = getOldestMessageMB(runningPCB);
+    }
+    else if((bindedMB = resolveMailBox(bindedMB)) == FAILURE)
+    {
+        return RECV_FAIL;
+    }
 
-            memcpy(contents, mailboxList[bindedMB].head->contents, copySize);
-            *maxSize = copySize;
-            Message * temp = mailboxList[bindedMB].head;
-            mailboxList[bindedMB].head = mailboxList[bindedMB].head->next;
-            addToPool(temp);
+    if(bindedMB!=ANY)
+    {
+        if (mailboxList[bindedMB].owner != runningPCB)
+        {return RECV_FAIL;}
+
+        // Drain as many queued messages as the caller has room for
+        while ((count < maxEntries) && hasMessage(bindedMB))
+        {
+            Message * temp = dequeueMessage(bindedMB);
+
+            entries[count].from = temp->from;
+            entries[count].size = temp->size;
+            entries[count].priority = temp->priority;
+            memcpy(entries[count].contents, MESSAGE_CONTENTS(temp), temp->size);
+            releaseMessage(temp);
+            count++;
+        }
+    }
+
+    if(!count)
+    {
+        // BLOCK
+        runningPCB->batch = entries;
+        blockReceiver(bindedMB, &(entries->from), entries->contents, MESSAGE_SYS_LIMIT, returnValue);
+    }
+    return count;
+}
+
+/*
+ * @brief   Subscribes a mailbox owned by the running process to a topic
+ * @param   [in] int topic: index of the topic
+ *          [in] int mailbox: MB # that will receive published messages
+ * @return  int: 1->success, -6->invalid topic or mailbox, or topic full
+ */
+int kernelSubscribe(int topic, int mailbox)
+{
+    int i;
+    Topic * selected;
+
+    mailbox = resolveMailBox(mailbox);
+
+    if(!(STARTING_INDEX <= topic && topic < TOPIC_AMOUNT) ||
+       (mailbox == FAILURE) ||
+       (mailboxList[mailbox].owner != getRunningPCB()))
+    {return TOPIC_FAIL;}
+
+    selected = &topicList[topic];
+
+    // Subscribing twice is not an error
+    for(i = 0; i < selected->count; i++)
+    {
+        if(selected->subscribers[i] == mailbox)
+        {return SUCCESS;}
+    }
+
+    if(selected->count >= MAX_SUBSCRIBERS)
+    {return TOPIC_FAIL;}
+
+    selected->subscribers[selected->count++] = mailbox;
+    return SUCCESS;
+}
+
+/*
+ * @brief   Removes a mailbox owned by the running process from a topic
+ * @param   [in] int topic: index of the topic
+ *          [in] int mailbox: MB # no longer receiving published messages
+ * @return  int: 1->success, -6->mailbox was not subscribed
+ */
+int kernelUnsubscribe(int topic, int mailbox)
+{
+    int i;
+    Topic * selected;
+
+    mailbox = resolveMailBox(mailbox);
+
+    if(!(STARTING_INDEX <= topic && topic < TOPIC_AMOUNT) ||
+       (mailbox == FAILURE) ||
+       (mailboxList[mailbox].owner != getRunningPCB()))
+    {return TOPIC_FAIL;}
+
+    selected = &topicList[topic];
+
+    for(i = 0; i < selected->count; i++)
+    {
+        if(selected->subscribers[i] == mailbox)
+        {
+            // Keep the list packed by moving the last subscriber into the gap
+            selected->subscribers[i] = selected->subscribers[--selected->count];
             return SUCCESS;
         }
     }
-    // BLOCK
-    removePCB();
-    runningPCB->from = returnMB;
-    runningPCB->contents = contents;
-    runningPCB->size = *maxSize;
-    runningPCB->returnValue = maxSize;
-    runningPCB->sp = get_PSP();
-    runningPCB = (struct ProcessControlBlock_*) getRunningPCB();
-    set_PSP(runningPCB->sp);
+    return TOPIC_FAIL;
+}
+
+/*
+ * @brief   Delivers a message to every mailbox subscribed to a topic.
+ *          The contents are copied once into a single payload that the
+ *          queued messages share, or inline into each message when small;
+ *          subscribers blocked in a receive are handed the message directly.
+ * @param   [in] int topic: index of the topic
+ *          [in] int fromMB: MB # of the publishing process
+ *          [in] void* contents: data to be published
+ *          [in] int size: amount of data measured in bytes
+ *          [in] int priority: priority sub-queue the messages are placed in
+ * @return  int: number of subscribers reached, -2->send failure
+ */
+int kernelPublish(int topic, int fromMB, void * contents, int size, int priority)
+{
+    int i;
+    int delivered = 0;
+    int subscriber;
+    PCB * owner;
+    MessageBuffer * newBuffer = NULL;
+    void * payload = contents;
+
+    int fromIndex = resolveMailBox(fromMB);
+
+    if(!(STARTING_INDEX <= topic && topic < TOPIC_AMOUNT) ||
+       (fromIndex == FAILURE) ||
+       (mailboxList[fromIndex].owner != getRunningPCB()) ||
+       (MESSAGE_SYS_LIMIT < size))
+    {return SEND_FAIL;}
+
+    if(size > SMALL_MESSAGE_LIMIT)
+    {
+        newBuffer = retrieveBufferFromPool();
+        if(!newBuffer)
+        {return SEND_FAIL;}
+
+        memcpy(newBuffer->contents, contents, size);
+        payload = newBuffer->contents;
+    }
 
-    *maxSize = runningPCB->size;
+    for(i = 0; i < topicList[topic].count; i++)
+    {
+        subscriber = topicList[topic].subscribers[i];
+        owner = mailboxList[subscriber].owner;
+
+        if(!owner)
+        {
+            continue;
+        }
+        mailboxList[subscriber].lastSender = mailboxList[fromIndex].owner;
+
+        if(isReceiving(owner, subscriber))
+        {
+            /* Subscriber is blocked so hand it the message directly */
+            deliverToBlocked(owner, fromMB, payload, size, priority);
+            recordDirectDelivery(subscriber);
+            delivered++;
+        }
+        else if(queueMessage(subscriber, fromMB, newBuffer, contents, size, priority) == SUCCESS)
+        {
+            delivered++;
+        }
+        else
+        {
+            sendFailed(subscriber);
+        }
+    }
+
+    // No queued message kept a reference to the payload
+    if(newBuffer && !newBuffer->refCount)
+    {
+        addBufferToPool(newBuffer);
+    }
+
+    return delivered;
+}
+
+/*
+ * @brief   Frees every name registered for a mailbox
+ * @param   [in] int mailbox: index of the mailbox being released
+ */
+void removeNames(int mailbox)
+{
+    int i;
+    for(i = 0; i < MB_NAME_AMOUNT; i++)
+    {
+        if((nameList[i].handle != ANY) && (MB_INDEX(nameList[i].handle) == mailbox))
+        {
+            nameList[i].handle = ANY;
+        }
+    }
+}
+
+/*
+ * @brief   Finds the registry entry holding a name
+ * @param   [in] char* name: name to find
+ * @return  MailBoxName *: entry holding the name, NULL if not registered
+ */
+MailBoxName * findName(char * name)
+{
+    int i;
+    for(i = 0; i < MB_NAME_AMOUNT; i++)
+    {
+        if((nameList[i].handle != ANY) &&
+           (strncmp(nameList[i].name, name, MB_NAME_LENGTH) == 0))
+        {
+            return &nameList[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * @brief   Registers a name for a mailbox owned by the running process.
+ *          Names are released when the mailbox is unbound.
+ * @param   [in] char* name: name of the service, at most MB_NAME_LENGTH - 1
+ *                           characters are significant
+ *          [in] int mailbox: MB # or handle the name resolves to
+ * @return  int: 1->success, -7->name taken, registry full or invalid mailbox
+ */
+int kernelRegisterName(char * name, int mailbox)
+{
+    int i;
+    int index = resolveMailBox(mailbox);
+
+    if((index == FAILURE) || (mailboxList[index].owner != getRunningPCB()) ||
+       findName(name))
+    {return NAME_FAIL;}
+
+    for(i = 0; i < MB_NAME_AMOUNT; i++)
+    {
+        if(nameList[i].handle == ANY)
+        {
+            strncpy(nameList[i].name, name, MB_NAME_LENGTH - 1);
+            nameList[i].name[MB_NAME_LENGTH - 1] = NUL;
+            // Always hand out the generation so lookups cannot outlive the binding
+            nameList[i].handle = MB_HANDLE(index, mailboxList[index].generation);
+            return SUCCESS;
+        }
+    }
+    return NAME_FAIL;
+}
+
+/*
+ * @brief   Looks up the mailbox handle registered for a name
+ * @param   [in] char* name: name of the service
+ * @return  int: handle of the mailbox, -7->name not registered
+ */
+int kernelLookupName(char * name)
+{
+    MailBoxName * entry = findName(name);
+    return (entry)? entry->handle : NAME_FAIL;
+}
+
+/*
+ * @brief   Copies out the statistics of a mailbox
+ * @param   [in] int mailbox: MB # or handle of the mailbox
+ *          [out] MailBoxStats* stats: where the statistics are copied
+ * @return  int: 1->success, -1->invalid mailbox
+ */
+int kernelGetMailBoxStats(int mailbox, MailBoxStats * stats)
+{
+    mailbox = resolveMailBox(mailbox);
+
+    if(mailbox == FAILURE)
+    {return FAILURE;}
+
+    memcpy(stats, &mailboxList[mailbox].stats, sizeof(MailBoxStats));
     return SUCCESS;
 }
 
+/*
+ * @brief   Waits until one of a set of the running process' mailboxes holds
+ *          a message or one of a set of notification sources is signalled.
+ *          Messages are left queued for the process to receive.
+ * @param   [in] int* mailboxes: MB #s or handles to wait on
+ *          [in] int count: number of mailboxes
+ *          [in] unsigned long sources: SOURCE_ bits to wait on
+ *          [out] unsigned long* readySources: sources that were signalled
+ *          [out] int* returnValue: where the result is written once a
+ *                                  blocked process is woken
+ * @return  int: handle of a mailbox holding a message, -9->only sources
+ *          are ready, -8->invalid mailbox or nothing to wait on
+ */
+int kernelWaitAny(int * mailboxes, int count, unsigned long sources,
+                  unsigned long * readySources, int * returnValue)
+{
+    int i;
+    int index;
+    PCB * runningPCB = (struct ProcessControlBlock_*) getRunningPCB();
+
+    if((count < 0) || (!count && !sources))
+    {return WAIT_FAIL;}
+
+    for(i = 0; i < count; i++)
+    {
+        index = resolveMailBox(mailboxes[i]);
+        if((index == FAILURE) || (mailboxList[index].owner != runningPCB))
+        {return WAIT_FAIL;}
+    }
+
+    *readySources = takeSources(sources);
+
+    for(i = 0; i < count; i++)
+    {
+        if(hasMessage(resolveMailBox(mailboxes[i])))
+        {return mailboxes[i];}
+    }
+
+    if(*readySources)
+    {return SOURCE_READY;}
+
+    // BLOCK until a send or signal wakes the process
+    runningPCB = blockPCB(WAIT_BLOCKED);
+    runningPCB->waitMailboxes = mailboxes;
+    runningPCB->waitCount = count;
+    runningPCB->waitSources = sources;
+    runningPCB->readySources = readySources;
+    runningPCB->returnValue = returnValue;
+
+    if(sources)
+    {
+        addSourceWaiter(runningPCB);
+    }
+    checkWaitChain(runningPCB);
+    return SOURCE_READY;
+}
+
+/*
+ * @brief   Copies out the owner and queue depth of every bound mailbox
+ * @param   [out] MailBoxInfo* list: where each mailbox is described
+ *          [in] int maxEntries: number of entries available
+ * @return  int: number of entries filled
+ */
+int kernelGetMailBoxList(MailBoxInfo * list, int maxEntries)
+{
+    int i;
+    int count = 0;
+
+    for(i = STARTING_INDEX; (i < MAILBOX_AMOUNT) && (count < maxEntries); i++)
+    {
+        if(mailboxList[i].owner)
+        {
+            list[count].index = i;
+            list[count].ownerPid = mailboxList[i].owner->pid;
+            list[count].depth = mailboxList[i].stats.depth;
+            list[count].peakDepth = mailboxList[i].stats.peakDepth;
+            list[count].sends = mailboxList[i].stats.sends;
+            count++;
+        }
+    }
+    return count;
+}
+
+/*
+ * @brief   Copies out the free, total and low water counts of the
+ *          message header, payload and receive log pools
+ * @param   [out] PoolInfo* info: where the counts are copied
+ */
+void kernelGetPoolInfo(PoolInfo * info)
+{
+    memcpy(info, &poolCounts, sizeof(PoolInfo));
+}
+
+/*
+ * @brief   Idle hook zeroing one freed message payload so stale message
+ *          data does not linger and payloads are handed out NUL padded.
+ *          Runs in the idle process; the pools are only otherwise touched
+ *          by kernel calls, so masking interrupts keeps them consistent.
+ */
+void idleScrubHook(void)
+{
+    MessageBuffer * dirty;
+
+    disable();
+    if((dirty = dirtyBufferPool))
+    {
+        dirtyBufferPool = dirty->next;
+        memset(dirty->contents, NUL, MESSAGE_SYS_LIMIT);
+        dirty->next = bufferPool;
+        bufferPool = dirty;
+    }
+    enable();
+}
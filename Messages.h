@@ -11,10 +11,78 @@
 #include "Process.h"
 #include "Utilities.h"
 
-/* Maximum number of message queues allowed */
-#define MAILBOX_AMOUNT 16
+/* Maximum number of message queues allowed. Set at configuration time by
+ * predefining MAILBOX_AMOUNT (at most MB_INDEX_MASK + 1); MB #s 0-12 are
+ * reserved for the well-known mailboxes in Utilities.h and the protocol
+ * layer headers
+ */
+#ifndef MAILBOX_AMOUNT
+#define MAILBOX_AMOUNT 32
+#endif
 #define MAILBOX_MAX_INDEX MAILBOX_AMOUNT - 1
 
+/* Mailbox handles carry the mailbox's generation above its index. The
+ * generation changes every time the mailbox is unbound so a stale handle
+ * cannot reach whoever binds it next. Handles with a generation of zero
+ * (the well-known MB #s) are not checked.
+ */
+#define MB_INDEX_BITS       8
+#define MB_INDEX_MASK       ((1 << MB_INDEX_BITS) - 1)
+#define MB_GENERATION_MASK  0xFF
+#define MB_HANDLE(index, generation)  (((generation) << MB_INDEX_BITS) | (index))
+#define MB_INDEX(handle)              ((handle) & MB_INDEX_MASK)
+#define MB_GENERATION(handle)         (((handle) >> MB_INDEX_BITS) & MB_GENERATION_MASK)
+
+/* Name registry mapping service names to mailbox handles */
+#define MB_NAME_AMOUNT  16
+#define MB_NAME_LENGTH  12
+
+/* Messages this small are copied into the message structure itself
+ * rather than taking a payload from the pool
+ */
+#define SMALL_MESSAGE_LIMIT 8
+
+/* Publish/subscribe topics and the subscribers each can fan out to */
+#define TOPIC_AMOUNT 8
+#define MAX_SUBSCRIBERS 4
+
+/* Queueing latency histogram: bucket 0 counts messages waiting fewer than
+ * 2^LATENCY_SHIFT SysTick clock cycles, every bucket after that doubles the
+ * range and the last bucket holds everything longer
+ */
+#define LATENCY_BUCKETS 16
+#define LATENCY_SHIFT   13
+
+/* Structure holding the traffic statistics of a mailbox since it was bound */
+typedef struct MailBoxStats_
+{
+    /* Messages accepted for the mailbox, queued or handed over directly */
+    unsigned long sends;
+    /* Messages taken out of the mailbox */
+    unsigned long receives;
+    /* Sends refused for lack of an owner, pool space or a bad size */
+    unsigned long failedSends;
+    /* Messages currently queued and the most ever queued at once */
+    int depth;
+    int peakDepth;
+    /* Time between a message being queued and received */
+    unsigned long latency[LATENCY_BUCKETS];
+
+}MailBoxStats;
+
+/* Pooled message payload; published messages share one between subscribers */
+typedef struct MessageBuffer_
+{
+    /* Number of queued messages still referring to this payload */
+    int refCount;
+
+    /*Next pointer for pool linked list*/
+    struct MessageBuffer_* next;
+
+    char contents[MESSAGE_SYS_LIMIT];
+
+}MessageBuffer;
+
 
 /* Structure containing information about messages */
 typedef struct Message_
@@ -27,11 +95,24 @@ typedef struct Message_
     struct Message_* next;
     /* Size in bytes of message */
     int size;
+    /* Priority sub-queue the message is held in */
+    int priority;
+    /* Kernel time the message was queued at */
+    unsigned long enqueueTime;
+    /* Correlation ID of the sender's work and when the sender took it on */
+    unsigned int correlation;
+    unsigned long correlationStamp;
 
-    char contents[MESSAGE_SYS_LIMIT];
+    /* Payload of the message, NULL if it is held inline */
+    MessageBuffer* buffer;
+    /* Payload of small messages */
+    char inlineContents[SMALL_MESSAGE_LIMIT];
 
 }Message;
 
+/* Address of a queued message's data wherever it is held */
+#define MESSAGE_CONTENTS(msg)   (((msg)->buffer)? (msg)->buffer->contents : (msg)->inlineContents)
+
 typedef struct ReceiveLog_
 {
     // Mailbox to check
@@ -51,10 +132,10 @@ typedef struct MailBox_
 {
     /* Owner of message queue */
     struct ProcessControlBlock_ * owner;
-    /* Index of first occupied slot in message queue */
-    Message* head;
-    /* Index of next empty slot in message queue */
-    Message* tail;
+    /* First message of each priority sub-queue */
+    Message* head[MESSAGE_PRIORITIES];
+    /* Last message of each priority sub-queue */
+    Message* tail[MESSAGE_PRIORITIES];
 
     // doubly linked list of free mailboxes
     struct MailBox_ * nextFree;
@@ -63,19 +144,91 @@ typedef struct MailBox_
 
     int index;
 
+    /* Current generation of handles to this mailbox */
+    int generation;
+
     ReceiveLog * oldest;
 
     ReceiveLog * newest;
 
+    MailBoxStats stats;
+
+    /* Process that last sent to the mailbox, the likeliest to wake its owner */
+    struct ProcessControlBlock_ * lastSender;
+
 }MailBox;
 
+/* Snapshot of a bound mailbox */
+typedef struct MailBoxInfo_
+{
+    int index;
+    unsigned int ownerPid;
+    int depth;
+    int peakDepth;
+    unsigned long sends;
+
+}MailBoxInfo;
+
+/* Snapshot of one of the kernel pools */
+typedef struct PoolCount_
+{
+    int free;
+    int total;
+    /* Fewest entries ever left free */
+    int lowWater;
+
+}PoolCount;
+
+/* Snapshot of the message header, payload and receive log pools */
+typedef struct PoolInfo_
+{
+    PoolCount messages;
+    PoolCount buffers;
+    PoolCount logs;
+
+}PoolInfo;
+
+/* Structure registering a name for a mailbox handle */
+typedef struct MailBoxName_
+{
+    char name[MB_NAME_LENGTH];
+
+    /* Handle the name resolves to; ANY when the entry is free */
+    int handle;
+
+}MailBoxName;
+
+/* Structure holding the mailboxes subscribed to a topic */
+typedef struct Topic_
+{
+    int subscribers[MAX_SUBSCRIBERS];
+
+    int count;
+
+}Topic;
+
 #ifndef GLOBAL_MESSAGES
 #define GLOBAL_MESSAGES
 
 extern int kernelBind(unsigned int);
 extern int kernelUnbind(unsigned int);
-extern int kernelSend(int,int,void *, int);
-extern int kernelReceive(int,int*,void*,int*);
+extern int kernelSend(int,int,void *, int, int);
+extern int kernelReceive(int,int*,void*,int*,int*);
+extern int kernelReceiveBatch(int,struct MessageEntry_ *,int,int *);
+extern int kernelSubscribe(int,int);
+extern int kernelUnsubscribe(int,int);
+extern int kernelPublish(int,int,void *,int,int);
+extern int kernelRegisterName(char *,int);
+extern int kernelLookupName(char *);
+extern int kernelGetMailBoxStats(int,MailBoxStats *);
+extern int kernelWaitAny(int *,int,unsigned long,unsigned long *,int *);
+extern PCB * getLastSender(int);
+extern int kernelGetMailBoxList(MailBoxInfo *, int);
+extern void kernelGetPoolInfo(PoolInfo *);
+extern int resolveMailBox(int);
+extern int latencyBucket(unsigned long);
+extern void releaseMailBoxes(PCB *);
+extern void idleScrubHook(void);
 extern void initMessagePool(void);
 extern void initMailBoxList(void);
 extern PCB * getOwnerPCB(int);
@@ -83,11 +236,30 @@ extern void initReceiveLogs(void);
 
 #else
 
-int kernelSend(int,int,void *, int);
-int kernelReceive(int,int*,void*,int*);
+int kernelSend(int,int,void *, int, int);
+int kernelReceive(int,int*,void*,int*,int*);
+int kernelReceiveBatch(int,struct MessageEntry_ *,int,int *);
+int kernelUnsubscribe(int,int);
+void enqueueMessage(int, Message *, ReceiveLog *);
+Message * dequeueMessage(int);
+int hasMessage(int);
+void resetMailBox(int);
 void addToPool(Message *);
 Message * retrieveFromPool(void);
+void addBufferToPool(MessageBuffer *);
+MessageBuffer * retrieveBufferFromPool(void);
+void releaseMessage(Message *);
+int queueMessage(int, int, MessageBuffer *, void *, int, int);
+int resolveMailBox(int);
+void removeNames(int);
 void addReceiveLog(ReceiveLog *);
 ReceiveLog * retrieveReceiveLog(void);
+int latencyBucket(unsigned long);
+void recordLatency(MailBoxStats *, unsigned long);
+int sendFailed(int);
+void recordDirectDelivery(int);
+int isReceiving(PCB *, int);
+void wakeMailBoxWaiter(int);
+void blockReceiver(int, int *, void *, int, int *);
 
 #endif /* GLOBAL_SVC */
@@ -1,7 +1,8 @@
 /*
  * @file    PhysLayerMessage.c
- * @brief   Contains handlers for incoming messages to physical
- *          layer from data link layer and UART1 handler
+ * @brief   Contains the handler for messages to the physical layer
+ *          from the data link layer. Frames from UART1 are assembled,
+ *          destuffed and checked by the UART1 receive ISR.
  * @author  Liam JA MacDonald
  * @author  Patrick Wells
  * @date    8-Dec-2019 (created)
@@ -11,6 +12,7 @@
 #include "KernelCall.h"
 #include "PhysLayerMessage.h"
 #include "Utilities.h"
+#include "Channel.h"
 
 /* Define number of bytes added to data link message by physical layer */
 #define NUMPHYSICALBYTES    (3)
@@ -42,11 +44,12 @@ unsigned char getChecksum(char * DLMsg, int msgSize)
 void PhysLayerFromDLHandler(void)
 {
     int Mailbox;
-    int senderMB;
-    int maxrecvSize = sizeof(DLMessage);
     int recvSize;
     int i;
+    int count;
+    int entry;
     char tempChecksum;
+    MessageEntry batch[PHYS_RECV_BATCH];
     /* Reserve space for a physical layer format message.
      * received points to first byte of container after
      * start byte (STX)
@@ -54,15 +57,19 @@ void PhysLayerFromDLHandler(void)
      * Field:       |Start|Message|Checksum|End|
      * Pointers:           received
      */
-    char toForward[(sizeof(DLMessage) * 2) + NUMPHYSICALBYTES];
+    char toForward[PHYS_FRAME_SIZE];
     char * received = &toForward[1];
     char * checksum;
+    Channel * toUART1;
 
     /* Bind to dedicated mailbox */
     Mailbox = bind(DATALINKPHYSMB);
 
-    /* Ensure bind was successful */
-    if(Mailbox == SUCCESS)
+    /* Frames go to the UART1 output server through a shared ring */
+    toUART1 = channelOpen(PHYS_UART1_CHANNEL, PHYS_FRAME_SIZE, PHYS_CHANNEL_DEPTH);
+
+    /* Ensure bind and channel open were successful */
+    if((Mailbox == SUCCESS) && toUART1)
     {
         /* Set start character of message to forward */
         toForward[0] = STX;
@@ -70,111 +77,60 @@ void PhysLayerFromDLHandler(void)
         /* Loop indefinitely while processing messages from data link layer */
         while(1)
         {
-            /* Receive message from data link layer. These messages will follow the DataLinkMessage format */
-            recvSize = maxrecvSize;
-            recvMessage(DATALINKPHYSMB, &senderMB, received, &recvSize);
-
-            /* Calculate checksum of message to forward */
-            tempChecksum = getChecksum(received, recvSize);
+            /* Receive every queued message from data link layer in one trap.
+             * These messages will follow the DataLinkMessage format
+             */
+            count = recvBatch(DATALINKPHYSMB, batch, PHYS_RECV_BATCH);
 
-            /* Add extra DLEs to message where necessary */
-            for(i = 0; i < recvSize; i++)
+            for(entry = 0; entry < count; entry++)
             {
-                /* Check whether current character is a special character */
-                if((received[i] == STX) ||
-                   (received[i] == ETX) ||
-                   (received[i] == DLE))
-                {
-                    /* First move contents of message to make room for extra character */
-                    memmove(&received[i + 1], &received[i], recvSize - i);
+                recvSize = (batch[entry].size < (int)sizeof(DLMessage))? batch[entry].size : (int)sizeof(DLMessage);
+                memcpy(received, batch[entry].contents, recvSize);
 
-                    /* Insert extra DLE character */
-                    received[i] = DLE;
+                /* Calculate checksum of message to forward */
+                tempChecksum = getChecksum(received, recvSize);
 
-                    /* Adjust iterator and message size */
-                    i++;
-                    recvSize++;
+                /* Add extra DLEs to message where necessary */
+                for(i = 0; i < recvSize; i++)
+                {
+                    /* Check whether current character is a special character */
+                    if((received[i] == STX) ||
+                       (received[i] == ETX) ||
+                       (received[i] == DLE))
+                    {
+                        /* First move contents of message to make room for extra character */
+                        memmove(&received[i + 1], &received[i], recvSize - i);
+
+                        /* Insert extra DLE character */
+                        received[i] = DLE;
+
+                        /* Adjust iterator and message size */
+                        i++;
+                        recvSize++;
+                    }
                 }
-            }
-
-            /* Update checksum pointer */
-            checksum = received + recvSize;
-            *checksum = tempChecksum;
-
-            /* Add ETX character and null terminator after checksum */
-            *(checksum + 1) = ETX;
-
-            /* Send this packet to UART1 handler for transmission */
-            sendMessage(UART1_OP_MB, DATALINKPHYSMB, toForward, recvSize + NUMPHYSICALBYTES);
-        }
-    }
-
-    /* If this return statement is reached, the process terminates because
-     * mailbox bind was unsuccessful
-     */
-    return;
-}
-
-
-/*
- * @brief   Handler of messages to physical layer
- *          received from UART1 handler
- */
-void PhysLayerFromUART1Handler(void)
-{
-    int UART1toPhysMB;
-    int senderMB;
-    int maxrecvSize = (sizeof(DLMessage) * 2) + NUMPHYSICALBYTES;
-    int recvSize;
-    int fwdSize;
-    int i;
-    /* Reserve space for a physical layer format message.
-     * toForward points to first byte of container after
-     * start byte (STX)
-     *
-     * Field:       |Start|Message|Checksum|End|
-     * Pointers:           toForward
-     */
-    char received[maxrecvSize];
-    char * toForward = &received[1];
-    char * checksum;
 
-    /* Bind to dedicated mailbox */
-    UART1toPhysMB = bind(UART1PHYSMB);
-
-    /* Ensure that mailbox bind was successful */
-    if(UART1toPhysMB == SUCCESS)
-    {
-        /* Loop indefinitely while processing messages received from
-         * UART1 handler
-         */
-        while(1)
-        {
-            /* Receive message from mailbox. These messages follow the PhysLayerMessage format */
-            recvSize = maxrecvSize;
-            recvMessage(UART1PHYSMB, &senderMB, received, &recvSize);
-            fwdSize = recvSize - NUMPHYSICALBYTES;
-
-            /* Remove extra DLEs from message to forward */
-            for(i = 0; i < fwdSize; i++)
-            {
-                /* Check if current character is a DLE */
-                if(toForward[i] == DLE)
+                /* Update checksum pointer; the checksum is escaped like
+                 * the message so the receiver never mistakes it for ETX
+                 */
+                checksum = received + recvSize;
+                if((tempChecksum == STX) ||
+                   (tempChecksum == ETX) ||
+                   (tempChecksum == DLE))
                 {
-                    /* Current character is a DLE so remove it */
-                    memmove(&toForward[i], &toForward[i + 1], fwdSize - i);
-                    fwdSize--;
+                    *checksum++ = DLE;
+                    recvSize++;
                 }
-            }
+                *checksum = tempChecksum;
 
-            /* Adjust checksum pointer */
-            checksum = toForward + fwdSize;
+                /* Add ETX character and null terminator after checksum */
+                *(checksum + 1) = ETX;
 
-            /* Calculate expected checksum of message to forward */
-            if(getChecksum(toForward, fwdSize) == *checksum)
-            {
-                /* Forward message to data link layer only if checksum is valid */
-                sendMessage(PHYSDATALINKMB, UART1PHYSMB, toForward, fwdSize);
+                /* Put this packet in the UART1 handler's ring for transmission.
+                 * The data link layer sends everything at one priority, so
+                 * frames leave in the order they were sequenced.
+                 */
+                channelSend(toUART1, toForward, recvSize + NUMPHYSICALBYTES);
             }
         }
     }
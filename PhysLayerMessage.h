@@ -13,8 +13,23 @@
 /* Define number of bytes added to message by physical layer */
 #define NUMPHYSICALBYTES    (3)
 
-/* Define physical layer mailboxes */
-#define UART1PHYSMB     (6)
+/* Maximum number of data link messages handled per receive */
+#define PHYS_RECV_BATCH     (4)
+
+/* Largest stuffed frame, message and checksum both escaped, and the
+ * channel carrying frames to the UART1 output server
+ */
+#define PHYS_FRAME_SIZE     (((sizeof(DLMessage) + 1) * 2) + 2)
+#define PHYS_UART1_CHANNEL  (0)
+#define PHYS_CHANNEL_DEPTH  (8)
+
+/* Largest received frame once destuffed: message followed by checksum */
+#define PHYS_PAYLOAD_SIZE   (sizeof(DLMessage) + 1)
+
+/* A message's bytes plus its one's complement checksum sum to this */
+#define PHYS_CHECKSUM_SUM   (0xFF)
+
+/* Define physical layer mailbox */
 #define DATALINKPHYSMB  (7)
 
 /* Define start, end and data link escape bytes */
@@ -22,6 +37,13 @@
 #define ETX         (0x03)
 #define DLE         (0x10)
 
+/* A frame assembled by the UART1 receive ISR, STX, ETX and DLEs removed */
+typedef struct PhysFrame_
+{
+    unsigned char length;
+    char bytes[PHYS_PAYLOAD_SIZE];
+
+}PhysFrame;
+
 void PhysLayerFromDLHandler(void);
-void PhysLayerFromUART1Handler(void);
 
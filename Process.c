@@ -61,6 +61,30 @@ __asm(" ldmia   r0!,{r4-r11}");
 __asm(" msr psp,r0");
 }
 
+#ifndef HOST_MODEL
+unsigned long get_PRIMASK(void)
+{
+/* Returns the interrupt mask; 1 when interrupts are disabled */
+__asm(" mrs     r0, primask");
+__asm(" bx  lr");
+return 0;
+}
+
+void set_PRIMASK(volatile unsigned long mask)
+{
+/* Restores an interrupt mask read by get_PRIMASK */
+__asm(" msr primask, r0");
+}
+
+unsigned long get_IPSR(void)
+{
+/* Returns the active exception number; 0 in thread mode */
+__asm(" mrs     r0, ipsr");
+__asm(" bx  lr");
+return 0;
+}
+#endif /* HOST_MODEL */
+
 unsigned long get_SP()
 {
 /**** Leading space required -- for label ****/
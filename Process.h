@@ -18,12 +18,21 @@
 #define PRIORITY_LEVELS 5
 
 #define SVC()   __asm(" SVC #0")
+#ifdef HOST_MODEL
+#define disable()
+#define enable()
+#else
 #define disable()   __asm(" cpsid i")
 #define enable()    __asm(" cpsie i")
+#endif
 #define STACKSIZE   1024
 #define MSP_RETURN 0xFFFFFFF9    //LR value: exception return using MSP as SP
 #define PSP_RETURN 0xFFFFFFFD    //LR value: exception return using PSP as SP
 
+/* What a process is waiting for while it is out of the waitingToRun queues */
+enum blockStates {READY, RECV_BLOCKED, WAIT_BLOCKED, SUSPENDED, CHANNEL_BLOCKED,
+                  MUTEX_BLOCKED, SEM_BLOCKED};
+
 /* Cortex default stack frame */
 
 typedef struct StackFrame_
@@ -58,22 +67,62 @@ typedef struct ProcessControlBlock_
 {
 /* Stack pointer - r13 (PSP) */
 unsigned long sp;
+/* Lowest address of the process' stack and its size class */
 unsigned long topOfStack;
+unsigned char stackClass;
 /* Process ID number */
 unsigned int pid;
 /* Links to adjacent PCBs */
 struct ProcessControlBlock_ *next;
 struct ProcessControlBlock_ *prev;
-/* Priority of process */
+/* Priority of process, raised while it holds a mutex a higher priority
+ * process waits on
+ */
 unsigned char priority;
+/* Priority the process runs at when nothing is inherited */
+unsigned char basePriority;
 /* Pointer to message storing space */
 int * returnValue;
 
 int xAxisCursorPosition;
+/* Terminal row the process prints on, its pid unless it moves */
+int yAxisCursorPosition;
+/* SysTick interrupts taken while the process was running, the count at
+ * the start of the load window and the percentage of the last window
+ */
+unsigned long cpuTicks;
+unsigned long cpuTicksMark;
+unsigned char cpuLoad;
+/* Most bytes of stack seen in use, STACK_USED_UNKNOWN until the stack
+ * is painted up to paintedTo's stopping point, the stack pointer
+ */
+unsigned int stackUsed;
+unsigned long paintedTo;
+/* Correlation ID of the work in hand and when the process took it on */
+unsigned int correlation;
+unsigned long correlationStamp;
 // Blocked Message variables
 int* from;
 int size;
 void* contents;
+int* msgPriority;
+/* Entries to fill if blocked in a batch receive */
+struct MessageEntry_ * batch;
+/* One of blockStates */
+int blockState;
+/* Mailbox index a blocked receive takes messages from, ANY for all */
+int waitMB;
+/* Mailboxes and notification sources a process blocked in waitAny wakes on */
+int * waitMailboxes;
+int waitCount;
+unsigned long waitSources;
+unsigned long * readySources;
+/* Next process waiting on a notification source, mutex or semaphore */
+struct ProcessControlBlock_ * waitNext;
+/* Mutex or semaphore the process is blocked on */
+int waitObject;
+/* Tick the process last left the waitingToRun queues */
+unsigned long blockedSince;
 
 struct ReceiveLog_ * receiveAnyHead;
 struct ReceiveLog_ * receiveAnyTail;
@@ -81,8 +130,8 @@ struct ReceiveLog_ * receiveAnyTail;
 } PCB;
 
 
-#ifndef GLOBAL_KERNELCALL
-#define GLOBAL_KERNELCALL
+#ifndef GLOBAL_PROCESS
+#define GLOBAL_PROCESS
 
 extern void set_LR(volatile unsigned long);
 extern unsigned long get_PSP();
@@ -90,6 +139,10 @@ extern void set_PSP(volatile unsigned long);
 extern unsigned long get_MSP(void);
 extern void set_MSP(volatile unsigned long);
 extern unsigned long get_SP();
+/* With HOST_MODEL predefined the PRIMASK and IPSR helpers come from HostModel.c */
+extern unsigned long get_PRIMASK(void);
+extern void set_PRIMASK(volatile unsigned long);
+extern unsigned long get_IPSR(void);
 extern void volatile save_registers();
 extern void volatile restore_registers();
 
@@ -41,7 +41,7 @@ int enqueue(interruptType intType)
     disable();
     /* gives circular queue functionality*/
     unsigned int tmpPtr = (selectedQueue->writePtr+1)&(MAX_QUEUE_SIZE-1);
-    if((tmpPtr == selectedQueue->readPtr)){return FULL;}
+    if((tmpPtr == selectedQueue->readPtr)){enable(); return FULL;}
     /* put character in queue and increment write ptr */
     selectedQueue->fifo[selectedQueue->writePtr].data = intType.data;
     selectedQueue->writePtr =tmpPtr;
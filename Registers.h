@@ -0,0 +1,44 @@
+/*
+ * @file    Registers.h
+ * @brief   Thin peripheral register access layer. Drivers name a
+ *          register with REGISTER() and only touch it through the
+ *          REG_ macros, so the same driver and ISR code runs against
+ *          the hardware or, with HOST_MODEL predefined, against the
+ *          simulated peripherals in HostModel.c.
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#pragma once
+
+/* A register is named by its address */
+#define REGISTER(addr)  ((volatile unsigned long *)(addr))
+
+#ifdef HOST_MODEL
+
+/* Accesses are routed through the model so reads and writes have the
+ * side effects of the real peripheral (FIFO pops, clear on write)
+ */
+#define REG_READ(reg)           hostRegRead(reg)
+#define REG_WRITE(reg, value)   hostRegWrite((reg), (value))
+
+extern unsigned long hostRegRead(volatile unsigned long *);
+extern void hostRegWrite(volatile unsigned long *, unsigned long);
+
+#else
+
+#define REG_READ(reg)           (*(reg))
+#define REG_WRITE(reg, value)   (*(reg) = (value))
+
+#endif /* HOST_MODEL */
+
+/* Read-modify-write helpers */
+#define REG_SET(reg, bits)      REG_WRITE((reg), REG_READ(reg) | (bits))
+#define REG_CLEAR(reg, bits)    REG_WRITE((reg), REG_READ(reg) & ~(bits))
+
+/* System control block registers shared by the kernel and drivers */
+#define NVIC_INT_CTRL_R         REGISTER(0xE000ED04)    // Interrupt Control and State Register
+#define NVIC_SYS_PRI3_R         REGISTER(0xE000ED20)    // System Handler Priority 3 Register
+#define NVIC_INT_CTRL_PENDSTSET 0x04000000  // SysTick exception is pending
+#define NVIC_INT_CTRL_PENDSVSET 0x10000000  // PendSV exception is pending
+#define NVIC_SYS_PRI3_PENDSV_LOW 0x00E00000 // PendSV at the lowest priority
@@ -18,6 +18,12 @@
 #include "Utilities.h"
 #include "SYSTICK.h"
 #include "UART.h"
+#include "Channel.h"
+#include "Semaphore.h"
+#include "Deadlock.h"
+#include "Trace.h"
+#include "Correlation.h"
+#include "Log.h"
 
 
 
@@ -25,8 +31,6 @@
 #define LOW_PRIORITY 0
 #define PRIORITY_LEVELS 5
 #define RUNNING waitingToRun[currentPriority]
-#define STACK_SIZE 1024*sizeof(unsigned long)
-#define INIT_SP (1024-16)*sizeof(unsigned long)
 #define THUMB_MODE 0x01000000
 static int currentPriority = 0;
 
@@ -38,7 +42,31 @@ static int currentPriority = 0;
 extern void terminate(void);
 
 static PCB * waitingToRun[PRIORITY_LEVELS];
-static volatile int pendType = CONTEXT;
+
+/* Every registered process, for walking blocked processes */
+static PCB * processTable[MAX_PROCESSES];
+static volatile int pendType = SIGNAL;
+
+/* PCBs and stacks of terminated processes, kept for reuse. A free stack
+ * holds the link to the next at its lowest address.
+ */
+typedef struct FreeStack_
+{
+    struct FreeStack_ * next;
+    /* TRUE once the idle paint hook has refilled it with STACK_PAINT */
+    int painted;
+}FreeStack;
+static PCB * pcbPool = NULL;
+static FreeStack * stackPool[STACK_CLASSES];
+/* pid given to the next spawned process */
+static unsigned int nextPid = 0;
+/* Tick the current CPU load window started at */
+static unsigned long loadWindowStart = 0;
+
+/* Notification sources signalled but not yet taken by a waiting process */
+static volatile unsigned long pendingSources = 0;
+/* Processes blocked in waitAny on at least one notification source */
+static PCB * sourceWaiters = NULL;
 /*
  * @brief   returns PCB of running process
  * @return  PCB *: address of running processes
@@ -49,6 +77,202 @@ PCB * getRunningPCB(void)
     return RUNNING;
 }
 
+/*
+ * @brief   Returns a registered process by its slot in the process table
+ * @param   [in] int slot: 0 to MAX_PROCESSES - 1
+ * @return  PCB *: PCB of the process, NULL if the slot is empty
+ */
+PCB * getProcess(int slot)
+{
+    return (0 <= slot && slot < MAX_PROCESSES)? processTable[slot] : NULL;
+}
+
+/*
+ * @brief   Copies out the state of every registered process
+ * @param   [out] ProcessInfo * list: where each process is described
+ *          [in] int maxEntries: number of entries available
+ * @return  int: number of entries filled
+ */
+int kernelGetProcessList(ProcessInfo * list, int maxEntries)
+{
+    int slot;
+    int count = 0;
+
+    for(slot = 0; (slot < MAX_PROCESSES) && (count < maxEntries); slot++)
+    {
+        if(processTable[slot])
+        {
+            list[count].pid = processTable[slot]->pid;
+            list[count].priority = processTable[slot]->priority;
+            list[count].basePriority = processTable[slot]->basePriority;
+            list[count].blockState = processTable[slot]->blockState;
+            list[count].cpuTicks = processTable[slot]->cpuTicks;
+            list[count].cpuLoad = processTable[slot]->cpuLoad;
+            list[count].stackUsed = processTable[slot]->stackUsed;
+            count++;
+        }
+    }
+    return count;
+}
+
+/*
+ * @brief   Fills part of a stack with STACK_PAINT so the deepest point
+ *          ever reached can be found later
+ * @param   [in] unsigned long from: lowest address painted
+ *          [in] unsigned long to: address painting stops at
+ */
+void paintStack(unsigned long from, unsigned long to)
+{
+    unsigned long * word;
+
+    for(word = (unsigned long *)from; word < (unsigned long *)to; word++)
+    {
+        *word = STACK_PAINT;
+    }
+}
+
+/*
+ * @brief   Takes a stack of a size class, from its free list when one has
+ *          been recycled, otherwise from the heap
+ * @param   [in] int stackClass: 0 to STACK_CLASSES - 1
+ *          [out] int * painted: TRUE if the stack was already painted
+ * @return  unsigned long: lowest address of the stack, 0 if none is left
+ */
+unsigned long takeStack(int stackClass, int * painted)
+{
+    FreeStack * stack = stackPool[stackClass];
+
+    if(stack)
+    {
+        stackPool[stackClass] = stack->next;
+        *painted = stack->painted;
+        return (unsigned long)stack;
+    }
+    *painted = FALSE;
+    return (unsigned long)malloc(STACK_CLASS_SIZE(stackClass));
+}
+
+/*
+ * @brief   Returns a terminated process' PCB and stack to their free lists
+ * @param   [in/out] PCB * process: PCB of the terminated process
+ */
+void recycleProcess(PCB * process)
+{
+    FreeStack * stack = (FreeStack *)process->topOfStack;
+
+    stack->next = stackPool[process->stackClass];
+    stack->painted = FALSE;
+    stackPool[process->stackClass] = stack;
+
+    process->next = pcbPool;
+    pcbPool = process;
+}
+
+/*
+ * @brief   Builds a process: takes a PCB and stack, recycled ones first,
+ *          lays out the initial stack frame, enters it in the process
+ *          table and adds it to waitingToRun with its priority.
+ *          Returning from the process' code terminates it. No more than
+ *          a free list link is painted here; a stack the idle hook has
+ *          not yet painted is painted by it while the process lives.
+ * @param   [in] void (*code)(void): pointer to the start of the process code
+ *          [in] unsigned int pid: Process ID of the new process
+ *          [in] int priority: Process' initial priority
+ *          [in] int stackClass: size class of the process' stack
+ * @return  PCB *: the new process, NULL if the priority is invalid or the
+ *                 process table or heap is full
+ */
+PCB * createProcess(void (*code)(void), unsigned int pid, int priority, int stackClass)
+{
+   int slot = 0;
+   int painted;
+   PCB * newProcess;
+   StackFrame * processSP;
+
+   /* Find a free slot in the process table */
+   while((slot < MAX_PROCESSES) && processTable[slot])
+   {
+       slot++;
+   }
+
+   /* First must check to ensure the requested priority is valid */
+   if(!((priority >= LOW_PRIORITY) && (priority <= HIGH_PRIORITY) && (slot < MAX_PROCESSES)))
+   {return NULL;}
+
+   if(pcbPool)
+   {
+       newProcess = pcbPool;
+       pcbPool = pcbPool->next;
+   }
+   else
+   {
+       newProcess = (PCB*)malloc(sizeof(PCB));
+   }
+   if(!newProcess)
+   {return NULL;}
+
+   newProcess->topOfStack = takeStack(stackClass, &painted);
+   if(!newProcess->topOfStack)
+   {
+       newProcess->next = pcbPool;
+       pcbPool = newProcess;
+       return NULL;
+   }
+
+   newProcess->stackClass = stackClass;
+   processSP = (StackFrame*) (newProcess->topOfStack + STACK_CLASS_SIZE(stackClass) - sizeof(StackFrame));
+
+   /* A stack painted while free only lost its free list link */
+   if(painted)
+   {
+       paintStack(newProcess->topOfStack, newProcess->topOfStack + sizeof(FreeStack));
+       newProcess->stackUsed=sizeof(StackFrame);
+   }
+   else
+   {
+       newProcess->stackUsed=STACK_USED_UNKNOWN;
+   }
+   newProcess->paintedTo=newProcess->topOfStack;
+   processSP -> psr = THUMB_MODE;
+   processSP -> pc = (unsigned long)code;
+   processSP -> lr = (unsigned long)terminate;
+   newProcess -> sp = (unsigned long) processSP;
+   newProcess -> pid = pid;
+
+   newProcess->contents=NULL;
+   newProcess->size=NULL;
+   newProcess->from=NULL;
+   newProcess->batch=NULL;
+   newProcess->msgPriority=NULL;
+   newProcess->blockState=READY;
+   newProcess->waitMB=ANY;
+   newProcess->waitMailboxes=NULL;
+   newProcess->waitCount=NULL;
+   newProcess->waitSources=NULL;
+   newProcess->readySources=NULL;
+   newProcess->waitNext=NULL;
+   newProcess->waitObject=ANY;
+   newProcess->basePriority=priority;
+   newProcess->blockedSince=NULL;
+   processTable[slot] = newProcess;
+   newProcess->xAxisCursorPosition=1;
+   newProcess->yAxisCursorPosition=pid;
+   newProcess->cpuTicks=NULL;
+   newProcess->cpuTicksMark=NULL;
+   newProcess->cpuLoad=NULL;
+   newProcess->correlation=NULL;
+   newProcess->correlationStamp=NULL;
+   newProcess->receiveAnyHead=newProcess->receiveAnyTail=NULL;
+   addPCB(newProcess, priority);
+
+   /* Spawned processes are numbered after every registered one */
+   if(pid >= nextPid)
+   {
+       nextPid = pid + 1;
+   }
+   return newProcess;
+}
+
 /*
  * @brief   Allocates a new process stack frame and PCB
  *          for the process being registered.
@@ -65,35 +289,47 @@ PCB * getRunningPCB(void)
  */
 int registerProcess(void (*code)(void), unsigned int pid, int priority)
 {
-   int result = 0;
+   /* Registered processes get the largest stack. Nothing runs yet, so
+    * it is painted straight away rather than by the idle hook
+    */
+   PCB * newProcess = createProcess(code, pid, priority, STACK_CLASSES - 1);
 
-   /* First must check to ensure the requested priority is valid */
-   if((priority >= LOW_PRIORITY) && (priority <= HIGH_PRIORITY))
-   {
+   if(!newProcess)
+   {return 1;}
 
-       /* Requested priority is valid so continue with process registration */
-       PCB * newProcess = (PCB*)malloc(sizeof(PCB));
-       newProcess->topOfStack = (unsigned long)malloc(STACK_SIZE);
-       StackFrame *processSP = (StackFrame*) (newProcess->topOfStack+(INIT_SP));
-       processSP -> psr = THUMB_MODE;
-       processSP -> pc = (unsigned long)code;
-       processSP -> lr = (unsigned long)terminate;
-       newProcess -> sp = (unsigned long) processSP;
-       newProcess -> pid = pid;
-
-       newProcess->contents=NULL;
-       newProcess->size=NULL;
-       newProcess->from=NULL;
-       newProcess->xAxisCursorPosition=1;
-       newProcess->receiveAnyHead=newProcess->receiveAnyTail=NULL;
-       addPCB(newProcess, priority);
-   }
-   else
-   {
-       /* Requested an invalid priority so must reject process */
-       result = 1;
-   }
-   return result;
+   paintStack(newProcess->topOfStack, newProcess->sp);
+   newProcess->paintedTo = newProcess->sp;
+   newProcess->stackUsed = sizeof(StackFrame);
+   return 0;
+}
+
+/*
+ * @brief   Starts a process while the kernel is running. The stack size is
+ *          rounded up to the smallest size class that holds it.
+ * @param   [in] void (*code)(void): pointer to the start of the process code
+ *          [in] int priority: Process' initial priority
+ *          [in] int stackSize: bytes of stack the process needs
+ * @return  int: pid of the new process, -1 if the stack is too large, the
+ *               priority is invalid or no process can be added
+ */
+int kernelSpawn(void (*code)(void), int priority, int stackSize)
+{
+    int stackClass = 0;
+    PCB * newProcess;
+
+    while((stackClass < STACK_CLASSES) && (STACK_CLASS_SIZE(stackClass) < stackSize))
+    {
+        stackClass++;
+    }
+    if(stackClass == STACK_CLASSES)
+    {return FAILURE;}
+
+    newProcess = createProcess(code, nextPid, priority, stackClass);
+    if(!newProcess)
+    {return FAILURE;}
+
+    LOG(LOG_SPAWN, newProcess->pid, priority);
+    return newProcess->pid;
 }
 
 /*
@@ -160,6 +396,92 @@ PCB * removePCB()
     return toRemove;
 }
 
+/*
+ * @brief   Removes a ready process from its waitingToRun queue wherever it
+ *          is in the queue
+ * @param   [in/out] PCB * toRemove: PCB of the process being removed
+ */
+void unlinkPCB(PCB * toRemove)
+{
+    int priority = toRemove->priority;
+
+    if(toRemove == toRemove->next)
+    {
+        /* Process was the queue's only entry */
+        waitingToRun[priority] = NULL;
+        if(priority == currentPriority)
+        {
+            decrementPriority();
+        }
+    }
+    else
+    {
+        toRemove->next->prev = toRemove->prev;
+        toRemove->prev->next = toRemove->next;
+        if(waitingToRun[priority] == toRemove)
+        {
+            waitingToRun[priority] = toRemove->next;
+        }
+    }
+}
+
+/*
+ * @brief   Changes the priority a process runs at, moving it to the new
+ *          waitingToRun queue if it is ready to run. Blocked processes are
+ *          queued at their new priority once they wake.
+ * @param   [in/out] PCB * process: PCB of the process
+ *          [in] int newPriority: priority to run at
+ */
+void changePriority(PCB * process, int newPriority)
+{
+    if(process->priority == newPriority)
+    {return;}
+
+    if(process->blockState == READY)
+    {
+        unlinkPCB(process);
+        addPCB(process, newPriority);
+    }
+    else
+    {
+        process->priority = newPriority;
+    }
+}
+
+/*
+ * @brief   Takes the running process out of its waitingToRun queue to wait
+ *          on something, recording what it waits on and since when. The
+ *          caller stores the wait details and handles the context switch.
+ * @param   [in] int state: one of blockStates
+ * @return  PCB *: PCB of the process that blocked
+ */
+PCB * blockPCB(int state)
+{
+    PCB * blocked;
+
+    TRACE(TRACE_BLOCK, state);
+    blocked = removePCB();
+    blocked->blockState = state;
+    blocked->blockedSince = getKernelTicks();
+    return blocked;
+}
+
+/*
+ * @brief   Frees a terminated process' slot in the process table
+ * @param   [in] PCB * process: PCB of the process
+ */
+void removeFromProcessTable(PCB * process)
+{
+    int slot;
+    for(slot = 0; slot < MAX_PROCESSES; slot++)
+    {
+        if(processTable[slot] == process)
+        {
+            processTable[slot] = NULL;
+        }
+    }
+}
+
 /*
  * @brief   Decrements operating priority until a non-empty queue is found
  */
@@ -193,53 +515,138 @@ void setPendType(int newPendState)
 }
 
 /*
- * @brief   pendSV ISR that carries out context switches
+ * @brief   Marks notification sources as ready and requests a pendSV to
+ *          wake any process waiting on them. Called from ISRs; a source
+ *          signalled while nobody waits stays pending until the next
+ *          waitAny on it.
+ * @param   [in] unsigned long sources: SOURCE_ bits being signalled
  */
-void pendSV(void)
+void signalSource(unsigned long sources)
 {
-    PCB* callerPCB;
+    pendingSources |= sources;
+    CALLPENDSV;
+}
 
-    switch(pendType)
+/*
+ * @brief   Claims the pending notification sources a process waits on
+ * @param   [in] unsigned long sources: SOURCE_ bits of interest
+ * @return  unsigned long: the bits that were pending, now cleared
+ */
+unsigned long takeSources(unsigned long sources)
+{
+    unsigned long ready;
+
+    disable();
+    ready = pendingSources & sources;
+    pendingSources &= ~ready;
+    enable();
+
+    return ready;
+}
+
+/*
+ * @brief   Adds a process blocked in waitAny to the source waiter list
+ * @param   [in/out] PCB * waiter: PCB of the blocked process
+ */
+void addSourceWaiter(PCB * waiter)
+{
+    waiter->waitNext = sourceWaiters;
+    sourceWaiters = waiter;
+}
+
+/*
+ * @brief   Removes a process from the source waiter list
+ * @param   [in/out] PCB * waiter: PCB of the process being woken
+ */
+void removeSourceWaiter(PCB * waiter)
+{
+    PCB ** link = &sourceWaiters;
+
+    while(*link && (*link != waiter))
     {
-    case INPUT_0:
-    if (get_UART0_InputState())
+        link = &((*link)->waitNext);
+    }
+
+    if(*link)
     {
-        save_registers();
-        callerPCB = RUNNING;
-        addPCB(getOwnerPCB(UART0_IP_MB),3);
-        if(RUNNING != callerPCB)
-        {
-            callerPCB -> sp = get_PSP();
-            set_PSP(RUNNING -> sp);
-        }
-        restore_registers();
+        *link = waiter->waitNext;
     }
-    break;
-    case TIMER:
-    if(getTimerProcessState()&&getTimerState())
+    waiter->waitNext = NULL;
+}
+
+/*
+ * @brief   Ends a process' waitAny and returns it to its waitingToRun
+ *          queue. The caller writes the process' return value.
+ * @param   [in/out] PCB * waiter: PCB of the process blocked in waitAny
+ */
+void wakeWaiter(PCB * waiter)
+{
+    if(waiter->waitSources)
     {
-        save_registers();
-        callerPCB = RUNNING;
-        addPCB(getOwnerPCB(TIMER_MB),4);
-        if(RUNNING != callerPCB)
+        removeSourceWaiter(waiter);
+    }
+    waiter->waitMailboxes = NULL;
+    waiter->waitCount = NULL;
+    waiter->waitSources = NULL;
+    waiter->blockState = READY;
+    addPCB(waiter, waiter->priority);
+}
+
+/*
+ * @brief   Hands pending notification sources to the processes waiting
+ *          on them. Must be called with interrupts disabled.
+ */
+void wakeSourceWaiters(void)
+{
+    PCB * waiter = sourceWaiters;
+    PCB * nextWaiter;
+    unsigned long ready;
+
+    while(waiter && pendingSources)
+    {
+        nextWaiter = waiter->waitNext;
+        ready = pendingSources & waiter->waitSources;
+
+        if(ready)
         {
-            callerPCB -> sp = get_PSP();
-            set_PSP(RUNNING -> sp);
+            pendingSources &= ~ready;
+            *(waiter->readySources) = ready;
+            *(waiter->returnValue) = SOURCE_READY;
+            wakeWaiter(waiter);
         }
-        restore_registers();
+        waiter = nextWaiter;
     }
-    break;
-   case CONTEXT:
+}
 
-        disable();
-        save_registers();
-        RUNNING -> sp = get_PSP();
+/*
+ * @brief   pendSV ISR that carries out context switches. Processes woken
+ *          by notification sources are made ready first; a CONTEXT pend
+ *          also moves on to the next process of the running priority.
+ */
+void pendSV(void)
+{
+    PCB* callerPCB;
+
+    disable();
+    save_registers();
+    callerPCB = RUNNING;
+
+    if(pendType == CONTEXT)
+    {
         RUNNING = RUNNING -> next;
+    }
+    pendType = SIGNAL;
+
+    wakeSourceWaiters();
+
+    if(RUNNING != callerPCB)
+    {
+        callerPCB -> sp = get_PSP();
         set_PSP(RUNNING -> sp);
-        restore_registers();
-        enable();
-    break;
+        TRACE(TRACE_SWITCH, callerPCB->pid);
     }
+    restore_registers();
+    enable();
 }
 
 /*
@@ -308,6 +715,13 @@ KernelArgs *kcaptr;
 PCB * callerPCB;
 SendMessage * sendMsg;
 ReceiveMessage * recvMsg;
+ReceiveBatch * recvBatchMsg;
+WaitAny * waitArgs;
+ChannelOpen * openArgs;
+WaitGraph * graphArgs;
+TraceRead * traceArgs;
+Spawn * spawnArgs;
+unsigned int enteredPid;
 
 if (firstSVCcall)
 {
@@ -353,6 +767,7 @@ else /* Subsequent SVCs */
  */
 
     kcaptr = (KernelArgs *) argptr -> r7;
+    enteredPid = RUNNING -> pid;
     switch(kcaptr -> code)
     {
     case GETID:
@@ -360,7 +775,11 @@ else /* Subsequent SVCs */
     break;
     case NICE:
         callerPCB = RUNNING;
-        kcaptr -> rtnvalue = addPCB(removePCB(),kcaptr->arg1);
+        /* A process holding a contended mutex keeps the priority it inherited */
+        callerPCB -> basePriority = kcaptr->arg1;
+        kcaptr -> rtnvalue = inheritedPriority(callerPCB);
+        kcaptr -> rtnvalue = addPCB(removePCB(),
+                                    (kcaptr->rtnvalue > (int)kcaptr->arg1)? kcaptr->rtnvalue : (int)kcaptr->arg1);
         /* Here, RUNNING has been changed to the PCB of the process that is to be
          * run next. If RUNNING does not point to the process that requested a nice()
          * then a context switch is required. Note that no registers are pushed/pulled
@@ -381,7 +800,7 @@ else /* Subsequent SVCs */
         sendMsg = (SendMessage *)kcaptr ->arg1;
         kcaptr ->rtnvalue =
                 kernelSend(sendMsg->destinationMB,sendMsg->fromMB,
-                           sendMsg->contents, sendMsg->size);
+                           sendMsg->contents, sendMsg->size, sendMsg->priority);
         if(RUNNING != callerPCB)
         {
             callerPCB -> sp = get_PSP();
@@ -392,15 +811,157 @@ else /* Subsequent SVCs */
         recvMsg = (ReceiveMessage *)kcaptr ->arg1;
         kcaptr->rtnvalue = *((int *)recvMsg->maxSize);
         if(kernelReceive(recvMsg->bindedMB,recvMsg->returnMB,
-                      recvMsg->contents, &(kcaptr->rtnvalue)) < 0)
+                      recvMsg->contents, &(kcaptr->rtnvalue), recvMsg->priority) < 0)
         {
             kcaptr->rtnvalue = FAILURE;
         }
     break;
+    case RECEIVEBATCH:
+        recvBatchMsg = (ReceiveBatch *)kcaptr ->arg1;
+        kcaptr->rtnvalue = kernelReceiveBatch(recvBatchMsg->bindedMB, recvBatchMsg->entries,
+                                              recvBatchMsg->maxEntries, &(kcaptr->rtnvalue));
+    break;
+    case SUBSCRIBE:
+        kcaptr->rtnvalue = kernelSubscribe(kcaptr->arg1, kcaptr->arg2);
+    break;
+    case UNSUBSCRIBE:
+        kcaptr->rtnvalue = kernelUnsubscribe(kcaptr->arg1, kcaptr->arg2);
+    break;
+    case PUBLISH:
+        callerPCB = RUNNING;
+        sendMsg = (SendMessage *)kcaptr ->arg1;
+        kcaptr ->rtnvalue =
+                kernelPublish(sendMsg->destinationMB,sendMsg->fromMB,
+                              sendMsg->contents, sendMsg->size, sendMsg->priority);
+        /* Publishing may have unblocked a higher priority subscriber */
+        if(RUNNING != callerPCB)
+        {
+            callerPCB -> sp = get_PSP();
+            set_PSP(RUNNING -> sp);
+        }
+    break;
+    case REGISTERNAME:
+        kcaptr->rtnvalue = kernelRegisterName((char *)kcaptr->arg1, kcaptr->arg2);
+    break;
+    case LOOKUPNAME:
+        kcaptr->rtnvalue = kernelLookupName((char *)kcaptr->arg1);
+    break;
+    case WAITANY:
+        callerPCB = RUNNING;
+        waitArgs = (WaitAny *)kcaptr ->arg1;
+        kcaptr->rtnvalue = kernelWaitAny(waitArgs->mailboxes, waitArgs->count, waitArgs->sources,
+                                         waitArgs->readySources, &(kcaptr->rtnvalue));
+        if(RUNNING != callerPCB)
+        {
+            callerPCB -> sp = get_PSP();
+            set_PSP(RUNNING -> sp);
+        }
+    break;
+    case CHANNELOPEN:
+        openArgs = (ChannelOpen *)kcaptr ->arg1;
+        kcaptr->rtnvalue = (int)kernelChannelOpen(openArgs->id, openArgs->elemSize, openArgs->depth);
+    break;
+    case CHANNELWAIT:
+    case CHANNELSIGNAL:
+        callerPCB = RUNNING;
+        kcaptr->rtnvalue = (kcaptr->code == CHANNELWAIT)?
+                kernelChannelWait(kcaptr->arg1, kcaptr->arg2) :
+                kernelChannelSignal(kcaptr->arg1, kcaptr->arg2);
+        /* The caller may have gone to sleep or woken a higher priority process */
+        if(RUNNING != callerPCB)
+        {
+            callerPCB -> sp = get_PSP();
+            set_PSP(RUNNING -> sp);
+        }
+    break;
+    case MUTEXLOCK:
+    case MUTEXUNLOCK:
+    case SEMWAIT:
+    case SEMSIGNAL:
+        callerPCB = RUNNING;
+        switch(kcaptr -> code)
+        {
+        case MUTEXLOCK:
+            kcaptr->rtnvalue = kernelMutexLock(kcaptr->arg1);
+        break;
+        case MUTEXUNLOCK:
+            kcaptr->rtnvalue = kernelMutexUnlock(kcaptr->arg1);
+        break;
+        case SEMWAIT:
+            kcaptr->rtnvalue = kernelSemWait(kcaptr->arg1);
+        break;
+        default:
+            kcaptr->rtnvalue = kernelSemSignal(kcaptr->arg1);
+        break;
+        }
+        /* The caller may have blocked, dropped an inherited priority or
+         * handed the object to a higher priority process
+         */
+        if(RUNNING != callerPCB)
+        {
+            callerPCB -> sp = get_PSP();
+            set_PSP(RUNNING -> sp);
+        }
+    break;
+    case SEMINIT:
+        kcaptr->rtnvalue = kernelSemInit(kcaptr->arg1, kcaptr->arg2);
+    break;
+    case GETWAITGRAPH:
+        graphArgs = (WaitGraph *)kcaptr ->arg1;
+        kcaptr->rtnvalue = kernelGetWaitGraph(graphArgs->entries, graphArgs->maxEntries,
+                                              graphArgs->minTicks);
+    break;
+    case GETDEADLOCK:
+        kcaptr->rtnvalue = kernelGetDeadlockReport((DeadlockReport *)kcaptr->arg1);
+    break;
+    case GETPROCESSES:
+        kcaptr->rtnvalue = kernelGetProcessList((ProcessInfo *)kcaptr->arg1, kcaptr->arg2);
+    break;
+    case GETMAILBOXES:
+        kcaptr->rtnvalue = kernelGetMailBoxList((MailBoxInfo *)kcaptr->arg1, kcaptr->arg2);
+    break;
+    case GETPOOL:
+        kernelGetPoolInfo((PoolInfo *)kcaptr->arg1);
+    break;
+    case GETTIMERS:
+        kernelGetTimerInfo((TimerInfo *)kcaptr->arg1);
+    break;
+    case GETTRACE:
+        traceArgs = (TraceRead *)kcaptr ->arg1;
+        kcaptr->rtnvalue = kernelGetTrace(traceArgs->records, traceArgs->start,
+                                          traceArgs->maxRecords);
+    break;
+    case CORRELATE:
+        kcaptr->rtnvalue = kernelCorrelate(kcaptr->arg1);
+    break;
+    case GETHOPSTATS:
+        kcaptr->rtnvalue = kernelGetHopStats(kcaptr->arg1, (HopStats *)kcaptr->arg2);
+    break;
+    case GETMBSTATS:
+        kcaptr->rtnvalue = kernelGetMailBoxStats(kcaptr->arg1, (MailBoxStats *)kcaptr->arg2);
+    break;
+    case SPAWN:
+        callerPCB = RUNNING;
+        spawnArgs = (Spawn *)kcaptr ->arg1;
+        kcaptr->rtnvalue = kernelSpawn(spawnArgs->code, spawnArgs->priority,
+                                       spawnArgs->stackSize);
+        if(RUNNING != callerPCB)
+        {
+            callerPCB -> sp = get_PSP();
+            set_PSP(RUNNING -> sp);
+        }
+    break;
     case TERMINATE:
-        callerPCB = removePCB();
-        free(&(callerPCB->sp));
-        free(callerPCB);
+        callerPCB = RUNNING;
+        LOG(LOG_TERMINATE, callerPCB->pid, 0);
+        /* Mailboxes are released while the process is still RUNNING; handing
+         * its mutexes on may then make a waiter RUNNING instead
+         */
+        releaseMailBoxes(callerPCB);
+        releaseMutexes(callerPCB);
+        unlinkPCB(callerPCB);
+        removeFromProcessTable(callerPCB);
+        recycleProcess(callerPCB);
         /* RUNNING must have changed here so the process stack pointer must be
          * changed accordingly. No registers are pulled here since they will all
          * be pulled once this service call is exited.
@@ -414,12 +975,156 @@ else /* Subsequent SVCs */
         kcaptr->rtnvalue= kernelUnbind( kcaptr->arg1);
     break;
     case BLOCK:
-           callerPCB = removePCB();
+           callerPCB = blockPCB(SUSPENDED);
            callerPCB -> sp = get_PSP();
            set_PSP(RUNNING -> sp);
     break;
     default:
         kcaptr -> rtnvalue = -1;
     }
+
+    /* Every case that switches process leaves RUNNING changed */
+    if(RUNNING -> pid != enteredPid)
+    {
+        TRACE(TRACE_SWITCH, enteredPid);
+    }
+}
+}
+
+/*
+ * @brief   Paints the next STACK_PAINT_WORDS of unused stack below the
+ *          stack pointer of a process started on an unpainted stack.
+ *          Interrupts are disabled so the process cannot run, and move
+ *          its stack pointer, while a chunk is painted. Its high water
+ *          mark is measured once the painting reaches the stack pointer.
+ */
+static void paintProcessStack(void)
+{
+    static int slot = 0;
+    PCB * process = NULL;
+    unsigned long end;
+    int tries;
+
+    disable();
+    for(tries = 0; !process && (tries < MAX_PROCESSES); tries++)
+    {
+        process = processTable[slot];
+        slot = (slot + 1) % MAX_PROCESSES;
+        if(process && ((process == RUNNING) || (process->stackUsed != STACK_USED_UNKNOWN)))
+        {
+            process = NULL;
+        }
+    }
+
+    if(process)
+    {
+        end = process->paintedTo + STACK_PAINT_WORDS * sizeof(unsigned long);
+        if(end >= process->sp)
+        {
+            end = process->sp;
+            process->stackUsed = sizeof(StackFrame);
+        }
+        paintStack(process->paintedTo, end);
+        process->paintedTo = end;
+    }
+    enable();
+}
+
+/*
+ * @brief   Idle hook painting one recycled stack. The stack is taken off
+ *          its free list while it is painted so a spawn cannot be handed
+ *          it half done. Once every free stack is painted, the stacks of
+ *          processes started on unpainted ones are painted a chunk at a
+ *          time.
+ */
+void idlePaintHook(void)
+{
+    int stackClass;
+    FreeStack ** link;
+    FreeStack * stack = NULL;
+
+    disable();
+    for(stackClass = 0; !stack && (stackClass < STACK_CLASSES); stackClass++)
+    {
+        for(link = &stackPool[stackClass]; *link && (*link)->painted; link = &((*link)->next));
+        if((stack = *link))
+        {
+            *link = stack->next;
+        }
+    }
+    enable();
+
+    if(stack)
+    {
+        stackClass--;
+        paintStack((unsigned long)stack, (unsigned long)stack + STACK_CLASS_SIZE(stackClass));
+
+        disable();
+        stack->painted = TRUE;
+        stack->next = stackPool[stackClass];
+        stackPool[stackClass] = stack;
+        enable();
+    }
+    else
+    {
+        paintProcessStack();
+    }
 }
+
+/*
+ * @brief   Idle hook measuring the deepest stack use of one process per
+ *          call, by finding the lowest word no longer holding STACK_PAINT.
+ *          Stacks not yet painted are left unknown.
+ */
+void idleHighWaterHook(void)
+{
+    static int slot = 0;
+    PCB * process = processTable[slot];
+    unsigned long * word;
+    unsigned long * end;
+    unsigned int used;
+
+    slot = (slot + 1) % MAX_PROCESSES;
+    if(!process || (process->stackUsed == STACK_USED_UNKNOWN))
+    {return;}
+
+    word = (unsigned long *)process->topOfStack;
+    end = (unsigned long *)(process->topOfStack + STACK_CLASS_SIZE(process->stackClass));
+    while((word < end) && (*word == STACK_PAINT))
+    {
+        word++;
+    }
+
+    used = (unsigned long)end - (unsigned long)word;
+    if(used > process->stackUsed)
+    {
+        process->stackUsed = used;
+    }
+}
+
+/*
+ * @brief   Idle hook turning each process' CPU ticks into a load
+ *          percentage once every LOAD_WINDOW ticks. While the system is
+ *          saturated the idle process does not run and the last loads
+ *          are kept.
+ */
+void idleLoadHook(void)
+{
+    int slot;
+    PCB * process;
+    unsigned long now = getKernelTicks();
+    unsigned long elapsed = now - loadWindowStart;
+
+    if(elapsed < LOAD_WINDOW)
+    {return;}
+
+    for(slot = 0; slot < MAX_PROCESSES; slot++)
+    {
+        if((process = processTable[slot]))
+        {
+            process->cpuLoad = ((process->cpuTicks - process->cpuTicksMark) * 100) / elapsed;
+            process->cpuTicksMark = process->cpuTicks;
+        }
+    }
+    loadWindowStart = now;
 }
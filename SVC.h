@@ -8,11 +8,57 @@
  */
 #pragma once
 #include "Process.h"
+#include "Registers.h"
 
-enum pendType {CONTEXT,INPUT_0,INPUT_1,TIMER};
+/* SIGNAL only wakes processes waiting on notification sources,
+ * CONTEXT also moves on to the next process of the running priority
+ */
+enum pendType {SIGNAL,CONTEXT};
+
+/* Most processes registered at once */
+#define MAX_PROCESSES 16
+
+/* Process stacks come in STACK_CLASSES sizes doubling from STACK_CLASS_MIN
+ * bytes; registered processes get the largest
+ */
+#define STACK_CLASSES       3
+#define STACK_CLASS_MIN     1024
+#define STACK_CLASS_SIZE(c) (STACK_CLASS_MIN << (c))
+
+/* Fill of unused stack, see idleHighWaterHook */
+#define STACK_PAINT         0xA5A5A5A5UL
+
+/* stackUsed of a process started on an unpainted stack, until the idle
+ * paint hook has painted it down to the stack pointer
+ */
+#define STACK_USED_UNKNOWN  0
+
+/* Words of a running process' stack painted per idle hook call, with
+ * interrupts disabled
+ */
+#define STACK_PAINT_WORDS   64
+
+/* Ticks over which idleLoadHook averages CPU load */
+#define LOAD_WINDOW         ONE_SECOND
+
+/* Snapshot of a registered process */
+typedef struct ProcessInfo_
+{
+    unsigned int pid;
+    unsigned char priority;
+    unsigned char basePriority;
+    /* One of blockStates */
+    int blockState;
+    unsigned long cpuTicks;
+    /* Percent of the last load window spent running */
+    unsigned char cpuLoad;
+    /* Most bytes of stack seen in use, or STACK_USED_UNKNOWN */
+    unsigned int stackUsed;
+
+}ProcessInfo;
 
 /* Macro used to set the priority of the pendSV interrupt */
-#define SETPENDSVPRIORITY ((*(volatile unsigned long *)0xE000ED20) |= 0x00E00000UL)
+#define SETPENDSVPRIORITY REG_SET(NVIC_SYS_PRI3_R, NVIC_SYS_PRI3_PENDSV_LOW)
 
 #ifndef GLOBAL_SVC
 #define GLOBAL_SVC
@@ -23,6 +69,19 @@ extern PCB * removePCB(void);
 extern void initpendSV(void);
 extern PCB * getRunningPCB(void);
 extern void setPendType(int);
+extern void signalSource(unsigned long);
+extern unsigned long takeSources(unsigned long);
+extern void addSourceWaiter(PCB *);
+extern void wakeWaiter(PCB *);
+extern void changePriority(PCB *, int);
+void removeFromProcessTable(PCB *);
+extern PCB * blockPCB(int);
+extern PCB * getProcess(int);
+extern int kernelGetProcessList(ProcessInfo *, int);
+extern int kernelSpawn(void (*)(void), int, int);
+extern void idlePaintHook(void);
+extern void idleHighWaterHook(void);
+extern void idleLoadHook(void);
 
 
 #else
@@ -33,5 +92,13 @@ PCB * removePCB(void);
 void initpendSV(void);
 void SVCall(void);
 void SVCHandler(StackFrame*);
+void removeSourceWaiter(PCB *);
+void unlinkPCB(PCB *);
+void changePriority(PCB *, int);
+void wakeSourceWaiters(void);
+void paintStack(unsigned long, unsigned long);
+unsigned long takeStack(int, int *);
+void recycleProcess(PCB *);
+PCB * createProcess(void (*)(void), unsigned int, int, int);
 
 #endif /* GLOBAL_SVC */
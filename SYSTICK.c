@@ -15,18 +15,27 @@
 #include "SVC.h"
 #include "InterruptType.h"
 #include "Queue.h"
+#include "KernelCall.h"
+#include "Trace.h"
+#include "Compositor.h"
 
 static interruptType systickEvent = {SYSTICK,NUL};
-static int timerBlocked = FALSE;
 static int timerSet = FALSE;
 
+/* SysTick interrupts taken since start up and the period between them */
+static volatile unsigned long tickCount = 0;
+static unsigned long tickPeriod = MAX_WAIT;
+
+/* Hundredths of a second left before the time server replies */
+static volatile int timerRemaining = 0;
+
 
 /*
  * @brief   Set the clock source to internal and enable the counter to interrupt
  */
 void SysTickStart(void)
 {
-ST_CTRL_R |= ST_CTRL_CLK_SRC | ST_CTRL_ENABLE;
+REG_SET(ST_CTRL_R, ST_CTRL_CLK_SRC | ST_CTRL_ENABLE);
 }
 
 /*
@@ -34,7 +43,7 @@ ST_CTRL_R |= ST_CTRL_CLK_SRC | ST_CTRL_ENABLE;
  */
 void SysTickStop(void)
 {
-ST_CTRL_R &= ~(ST_CTRL_ENABLE);
+REG_CLEAR(ST_CTRL_R, ST_CTRL_ENABLE);
 }
 
 /*
@@ -45,7 +54,8 @@ void SysTickPeriod(unsigned long Period)
 /*
  For an interrupt, must be between 2 and 16777216 (0x100.0000 or 2^24)
 */
-ST_RELOAD_R = Period - 1;  /* 1 to 0xff.ffff */
+REG_WRITE(ST_RELOAD_R, Period - 1);  /* 1 to 0xff.ffff */
+tickPeriod = Period;
 }
 
 /*
@@ -54,7 +64,7 @@ ST_RELOAD_R = Period - 1;  /* 1 to 0xff.ffff */
 void SysTickIntEnable(void)
 {
 // Set the interrupt bit in STCTRL
-ST_CTRL_R |= ST_CTRL_INTEN;
+REG_SET(ST_CTRL_R, ST_CTRL_INTEN);
 }
 
 /*
@@ -63,16 +73,63 @@ ST_CTRL_R |= ST_CTRL_INTEN;
 void SysTickIntDisable(void)
 {
 // Clear the interrupt bit in STCTRL
-ST_CTRL_R &= ~(ST_CTRL_INTEN);
+REG_CLEAR(ST_CTRL_R, ST_CTRL_INTEN);
+}
+
+/*
+ * @brief   Returns the number of SysTick interrupts taken since start up
+ */
+unsigned long getKernelTicks(void)
+{
+    return tickCount;
+}
+
+/*
+ * @brief   Free running time stamp built from the tick count and the
+ *          SysTick down counter. Meant for measuring short intervals by
+ *          subtraction; wraps around every 2^32 SysTick clock cycles.
+ * @return  unsigned long: time in SysTick clock cycles
+ */
+unsigned long getKernelTime(void)
+{
+    unsigned long ticks;
+    unsigned long current;
+
+    /* Re-read if a tick was taken between the two reads */
+    do
+    {
+        ticks = tickCount;
+        current = REG_READ(ST_CURRENT_R);
+    } while(ticks != tickCount);
+
+    /* When called from the kernel the counter may have reloaded while
+     * the SysTick interrupt waits to be taken
+     */
+    if(REG_READ(NVIC_INT_CTRL_R) & NVIC_INT_CTRL_PENDSTSET)
+    {
+        current = REG_READ(ST_CURRENT_R);
+        ticks++;
+    }
+
+    return (ticks * tickPeriod) + (tickPeriod - 1 - current);
 }
 
 int getTimerState(void)
 {
     return timerSet;
 }
-int getTimerProcessState(void)
+
+/*
+ * @brief   Copies out the tick count, tick period and the state of
+ *          the user timer
+ * @param   [out] TimerInfo* info: where the snapshot is copied
+ */
+void kernelGetTimerInfo(TimerInfo * info)
 {
-    return timerBlocked;
+    info->ticks = tickCount;
+    info->period = tickPeriod;
+    info->timerSet = timerSet;
+    info->remaining = timerRemaining;
 }
 /*
  * @brief   set timer to delay with time variable that
@@ -91,20 +148,23 @@ void timeServer(void)
     interruptType timerTrigger = {SYSTICK,NUL};
     int toMB;
     char cont[MESSAGE_SYS_LIMIT];
-    int size = MESSAGE_SYS_LIMIT;
-    volatile int time;
+    int size;
+    unsigned long ready;
     while (1)
     {
-        recvMessage(TIMER_MB, &toMB, cont, size);
-        myAtoi(&time, cont);
+        /* Senders may leave off the terminator, so room is kept for one */
+        size = MESSAGE_SYS_LIMIT - 1;
+        recvMessage(TIMER_MB, &toMB, cont, &size);
+        cont[size] = NUL;
+        myAtoi((int *)&timerRemaining, cont);
         timerSet = TRUE;
         while(timerSet==TRUE)
         {
         if (dequeue(&timerTrigger))
         {
-            if(time>0)
+            if(timerRemaining>0)
             {
-                time--;
+                timerRemaining--;
             }
             else
             {
@@ -113,9 +173,8 @@ void timeServer(void)
         }
         else
         {
-             timerBlocked = TRUE;
-             block();
-             timerBlocked = FALSE;
+             /* Sleep until the SysTick ISR queues another tick */
+             waitAny(NULL, 0, SOURCE_TIMER, &ready);
         }
         }
         sendMessage(toMB, TIMER_MB," DONE ", 6);
@@ -128,14 +187,25 @@ void timeServer(void)
  */
 void SYSTICKHandler(void)
 {
+    tickCount++;
+    TRACE(TRACE_ISR_ENTRY, SYSTICK);
+    getRunningPCB()->cpuTicks++;
+
     setPendType(CONTEXT);
     CALLPENDSV;
 
+    /* Frame period for the compositor */
+    if(!(tickCount % COMPOSITOR_FRAME_TICKS))
+    {
+        signalSource(SOURCE_FRAME);
+    }
+
     if(getTimerState())
     {
-        setPendType(TIMER);
         systickEvent.type=SYSTICK;
         enqueue(systickEvent);
+        signalSource(SOURCE_TIMER);
     }
 
+    TRACE(TRACE_ISR_EXIT, SYSTICK);
 }
@@ -11,10 +11,13 @@
  */
 
 #pragma once
+#include "Registers.h"
 
-#define ST_CTRL_R   (*((volatile unsigned long *)0xE000E010))
+#define ST_CTRL_R   REGISTER(0xE000E010)
 // Systick Reload Value Register (STRELOAD)
-#define ST_RELOAD_R (*((volatile unsigned long *)0xE000E014))
+#define ST_RELOAD_R REGISTER(0xE000E014)
+// Systick Current Value Register (STCURRENT)
+#define ST_CURRENT_R REGISTER(0xE000E018)
 
 // SysTick defines
 #define ST_CTRL_COUNT      0x00010000  // Count Flag for STCTRL
@@ -24,7 +27,19 @@
 
 // Maximum period
 #define MAX_WAIT           0x1000000   /* 2^24 */
-#define HUNDREDTH_WAIT     0x27100 //(2^24)/100
+// Period of a hundredth of a second for a given system clock
+#define HUNDREDTH_WAIT(clock)   ((clock) / 100)
+
+/* Snapshot of the kernel tick and the user timer */
+typedef struct TimerInfo_
+{
+    unsigned long ticks;
+    unsigned long period;
+    int timerSet;
+    /* Hundredths of a second left on the user timer */
+    int remaining;
+
+}TimerInfo;
 
 #ifndef GLOBAL_SYSTICK
 #define GLOBAL_SYSTICK
@@ -34,9 +49,11 @@
     extern void SysTickPeriod(unsigned long);
     extern void SysTickIntEnable(void);
     extern void SysTickIntDisable(void);
-    extern void SysTickHandler(void);
+    extern void SYSTICKHandler(void);
     extern int getTimerState(void);
-    extern int getTimerProcessState(void);
     extern void timeServer(void);
+    extern unsigned long getKernelTime(void);
+    extern unsigned long getKernelTicks(void);
+    extern void kernelGetTimerInfo(TimerInfo *);
 
 #endif //GLOBAL_SYSTICK
@@ -0,0 +1,275 @@
+/*
+ * @file    Semaphore.c
+ * @brief   Contains the kernel side of mutexes and counting semaphores.
+ *          A process blocked on a mutex lends its priority to the owner
+ *          (and on through any mutex the owner is itself blocked on), and
+ *          an unlock or signal hands the object straight to the highest
+ *          priority waiter so a lower priority process cannot take it first.
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#include "SVC.h"
+#define GLOBAL_SEMAPHORE
+#include "Semaphore.h"
+#include "Deadlock.h"
+
+/*Mutex and semaphore tables; mutexes start out free*/
+static Mutex mutexList[MUTEX_AMOUNT];
+static Semaphore semaphoreList[SEMAPHORE_AMOUNT];
+
+/*
+ * @brief   Links a blocked process into a waiter list behind every waiter
+ *          of the same or higher priority
+ * @param   [in/out] PCB ** list: head of the waiter list
+ *          [in/out] PCB * waiter: PCB of the blocked process
+ */
+void insertWaiter(PCB ** list, PCB * waiter)
+{
+    while(*list && ((*list)->priority >= waiter->priority))
+    {
+        list = &((*list)->waitNext);
+    }
+    waiter->waitNext = *list;
+    *list = waiter;
+}
+
+/*
+ * @brief   Unlinks a process from a waiter list
+ * @param   [in/out] PCB ** list: head of the waiter list
+ *          [in/out] PCB * waiter: PCB being removed
+ */
+void removeWaiter(PCB ** list, PCB * waiter)
+{
+    while(*list && (*list != waiter))
+    {
+        list = &((*list)->waitNext);
+    }
+
+    if(*list)
+    {
+        *list = waiter->waitNext;
+    }
+    waiter->waitNext = NULL;
+}
+
+/*
+ * @brief   Takes the highest priority process off a waiter list and
+ *          returns it to its waitingToRun queue
+ * @param   [in/out] PCB ** list: head of a non-empty waiter list
+ * @return  PCB *: the process woken
+ */
+PCB * handOff(PCB ** list)
+{
+    PCB * waiter = *list;
+
+    *list = waiter->waitNext;
+    waiter->waitNext = NULL;
+    waiter->blockState = READY;
+    waiter->waitObject = ANY;
+    addPCB(waiter, waiter->priority);
+
+    return waiter;
+}
+
+/*
+ * @brief   Raises a mutex owner to a blocked waiter's priority, following
+ *          the chain while each owner is itself blocked on a mutex
+ * @param   [in/out] PCB * owner: PCB holding the mutex
+ *          [in] int priority: priority of the process that blocked
+ */
+void inheritPriority(PCB * owner, int priority)
+{
+    Mutex * blockedOn;
+
+    while(owner && (owner->priority < priority))
+    {
+        changePriority(owner, priority);
+
+        if(owner->blockState != MUTEX_BLOCKED)
+        {break;}
+
+        // Keep the owner's place in its own wait list in priority order
+        blockedOn = &mutexList[owner->waitObject];
+        removeWaiter(&blockedOn->waiters, owner);
+        insertWaiter(&blockedOn->waiters, owner);
+        owner = blockedOn->owner;
+    }
+}
+
+/*
+ * @brief   Finds the highest priority a process inherits from the waiters
+ *          of the mutexes it holds
+ * @param   [in] PCB * owner: PCB of the process
+ * @return  int: inherited priority, -1 if nothing is inherited
+ */
+int inheritedPriority(PCB * owner)
+{
+    int i;
+    int priority = FAILURE;
+
+    for(i = 0; i < MUTEX_AMOUNT; i++)
+    {
+        if((mutexList[i].owner == owner) && mutexList[i].waiters &&
+           (mutexList[i].waiters->priority > priority))
+        {
+            priority = mutexList[i].waiters->priority;
+        }
+    }
+    return priority;
+}
+
+/*
+ * @brief   Returns the process holding a mutex
+ * @param   [in] int id: index of the mutex
+ * @return  PCB *: PCB of the owner, NULL if the mutex is free or invalid
+ */
+PCB * getMutexOwner(int id)
+{
+    return (0 <= id && id < MUTEX_AMOUNT)? mutexList[id].owner : NULL;
+}
+
+/*
+ * @brief   Locks a mutex for the running process, blocking while another
+ *          process holds it
+ * @param   [in] int id: index of the mutex
+ * @return  int: 1->success, -10->invalid mutex or already held by the caller
+ */
+int kernelMutexLock(int id)
+{
+    Mutex * mutex;
+    PCB * runningPCB = getRunningPCB();
+
+    if(!(0 <= id && id < MUTEX_AMOUNT))
+    {return SYNC_FAIL;}
+
+    mutex = &mutexList[id];
+
+    if(!mutex->owner)
+    {
+        mutex->owner = runningPCB;
+        return SUCCESS;
+    }
+
+    if(mutex->owner == runningPCB)
+    {return SYNC_FAIL;}
+
+    // BLOCK until the owner hands the mutex over
+    runningPCB = blockPCB(MUTEX_BLOCKED);
+    runningPCB->waitObject = id;
+    insertWaiter(&mutex->waiters, runningPCB);
+    inheritPriority(mutex->owner, runningPCB->priority);
+    checkWaitChain(runningPCB);
+
+    return SUCCESS;
+}
+
+/*
+ * @brief   Unlocks a mutex held by the running process. Ownership passes
+ *          directly to the highest priority waiter and the caller drops
+ *          back to the priority it has not inherited.
+ * @param   [in] int id: index of the mutex
+ * @return  int: 1->success, -10->invalid mutex or not held by the caller
+ */
+int kernelMutexUnlock(int id)
+{
+    int priority;
+    Mutex * mutex;
+    PCB * runningPCB = getRunningPCB();
+
+    if(!(0 <= id && id < MUTEX_AMOUNT) || (mutexList[id].owner != runningPCB))
+    {return SYNC_FAIL;}
+
+    mutex = &mutexList[id];
+    mutex->owner = (mutex->waiters)? handOff(&mutex->waiters) : NULL;
+
+    priority = inheritedPriority(runningPCB);
+    changePriority(runningPCB, (priority > runningPCB->basePriority)?
+                               priority : runningPCB->basePriority);
+    return SUCCESS;
+}
+
+/*
+ * @brief   Hands every mutex a terminating process holds to its highest
+ *          priority waiter, or frees it
+ * @param   [in] PCB * owner: PCB of the terminating process
+ */
+void releaseMutexes(PCB * owner)
+{
+    int id;
+    Mutex * mutex;
+
+    for(id = 0; id < MUTEX_AMOUNT; id++)
+    {
+        mutex = &mutexList[id];
+        if(mutex->owner == owner)
+        {
+            mutex->owner = (mutex->waiters)? handOff(&mutex->waiters) : NULL;
+        }
+    }
+}
+
+/*
+ * @brief   Sets a semaphore's count
+ * @param   [in] int id: index of the semaphore
+ *          [in] int count: initial count
+ * @return  int: 1->success, -10->invalid semaphore, count or processes
+ *          still waiting on it
+ */
+int kernelSemInit(int id, int count)
+{
+    if(!(0 <= id && id < SEMAPHORE_AMOUNT) || (count < 0) ||
+       semaphoreList[id].waiters)
+    {return SYNC_FAIL;}
+
+    semaphoreList[id].count = count;
+    return SUCCESS;
+}
+
+/*
+ * @brief   Takes a semaphore, blocking while its count is zero
+ * @param   [in] int id: index of the semaphore
+ * @return  int: 1->success, -10->invalid semaphore
+ */
+int kernelSemWait(int id)
+{
+    PCB * runningPCB;
+
+    if(!(0 <= id && id < SEMAPHORE_AMOUNT))
+    {return SYNC_FAIL;}
+
+    if(semaphoreList[id].count > 0)
+    {
+        semaphoreList[id].count--;
+        return SUCCESS;
+    }
+
+    // BLOCK until a signal hands the count over
+    runningPCB = blockPCB(SEM_BLOCKED);
+    runningPCB->waitObject = id;
+    insertWaiter(&semaphoreList[id].waiters, runningPCB);
+
+    return SUCCESS;
+}
+
+/*
+ * @brief   Gives a semaphore; the count goes straight to the highest
+ *          priority waiter if there is one
+ * @param   [in] int id: index of the semaphore
+ * @return  int: 1->success, -10->invalid semaphore
+ */
+int kernelSemSignal(int id)
+{
+    if(!(0 <= id && id < SEMAPHORE_AMOUNT))
+    {return SYNC_FAIL;}
+
+    if(semaphoreList[id].waiters)
+    {
+        handOff(&semaphoreList[id].waiters);
+    }
+    else
+    {
+        semaphoreList[id].count++;
+    }
+    return SUCCESS;
+}
@@ -0,0 +1,57 @@
+/*
+ * @file    Semaphore.h
+ * @brief   Contains the kernel mutex and counting semaphore structures
+ *          and function prototypes. Mutexes use priority inheritance and
+ *          both objects hand ownership straight to their highest priority
+ *          waiter.
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#pragma once
+#include "Process.h"
+#include "Utilities.h"
+
+/* Number of mutexes and counting semaphores available */
+#define MUTEX_AMOUNT        8
+#define SEMAPHORE_AMOUNT    8
+
+/* Structure of a mutex */
+typedef struct Mutex_
+{
+    /* Process holding the mutex, NULL when free */
+    struct ProcessControlBlock_ * owner;
+    /* Blocked processes, highest priority first */
+    struct ProcessControlBlock_ * waiters;
+
+}Mutex;
+
+/* Structure of a counting semaphore */
+typedef struct Semaphore_
+{
+    int count;
+    /* Blocked processes, highest priority first */
+    struct ProcessControlBlock_ * waiters;
+
+}Semaphore;
+
+#ifndef GLOBAL_SEMAPHORE
+#define GLOBAL_SEMAPHORE
+
+extern int kernelMutexLock(int);
+extern int kernelMutexUnlock(int);
+extern int kernelSemInit(int, int);
+extern int kernelSemWait(int);
+extern int kernelSemSignal(int);
+extern int inheritedPriority(PCB *);
+extern PCB * getMutexOwner(int);
+extern void releaseMutexes(PCB *);
+
+#else
+
+void insertWaiter(PCB **, PCB *);
+void removeWaiter(PCB **, PCB *);
+void inheritPriority(PCB *, int);
+PCB * handOff(PCB **);
+
+#endif /* GLOBAL_SEMAPHORE */
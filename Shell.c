@@ -0,0 +1,311 @@
+/*
+ * @file    Shell.c
+ * @brief   Contains the low priority diagnostic shell. Commands typed on
+ *          UART0 after SHELL_PREFIX are answered from snapshots the kernel
+ *          copies out, so scheduling carries on while the shell looks.
+ *          ps      processes, priorities, state, CPU and stack use
+ *          mbox    bound mailboxes, owners and depths
+ *          pool    free, total and low water counts of the kernel pools
+ *          timers  kernel tick and the user timer
+ *          link    data link traffic counters
+ *          trace   dump of the kernel event trace, see Trace.h
+ *          hops    latency of correlated work at each mailbox and channel
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#include <string.h>
+#include <stdio.h>
+#include "KernelCall.h"
+#include "SVC.h"
+#include "SYSTICK.h"
+#include "Messages.h"
+#include "DataLinkMessage.h"
+#include "Trace.h"
+#include "UART.h"
+#include "Correlation.h"
+#include "Utilities.h"
+#define GLOBAL_SHELL
+#include "Shell.h"
+
+/* Structure pairing a command with the routine answering it */
+typedef struct ShellCommand_
+{
+    char * name;
+    void (*run)(void);
+}ShellCommand;
+
+/*Next row of the shell's area to write on*/
+static int shellRow;
+
+/* Mailbox bound under SHELL_NAME */
+static int shellMB;
+
+/*Short names of blockStates*/
+static char * stateNames[] = {"RDY", "RECV", "WAIT", "SUSP", "CHAN", "MUTX", "SEM"};
+
+/*
+ * @brief   Writes a line on the next free row of the shell's area. The
+ *          row goes with the line as a cursor position, so the line lands
+ *          in place however many are still waiting to be drawn.
+ * @param   [in] char* line: NUL terminated line of at most
+ *          MESSAGE_SYS_LIMIT - 1 characters
+ */
+static void shellPrint(char * line)
+{
+    Cursor position;
+
+    if(shellRow < SHELL_ROWS)
+    {
+        formatCursor(SHELL_FIRST_ROW + shellRow, 1, (char *)&position);
+        sendMessage(UART0_OP_MB, shellMB, &position, sizeof(Cursor));
+        sendMessage(UART0_OP_MB, shellMB, CLEAR_LINE, strlen(CLEAR_LINE) + 1);
+        sendMessage(UART0_OP_MB, shellMB, line, strlen(line) + 1);
+        shellRow++;
+    }
+}
+
+/*
+ * @brief   Lists every registered process
+ */
+static void shellPs(void)
+{
+    ProcessInfo list[MAX_PROCESSES];
+    char line[MESSAGE_SYS_LIMIT];
+    char stack[MESSAGE_SYS_LIMIT];
+    int count = getProcessList(list, MAX_PROCESSES);
+    int i;
+
+    shellPrint(" ID PRI STATE CPU% STACK");
+    for(i = 0; i < count; i++)
+    {
+        /* Stacks still being painted have no high water mark yet */
+        if(list[i].stackUsed == STACK_USED_UNKNOWN)
+        {
+            strcpy(stack, "?");
+        }
+        else
+        {
+            sprintf(stack, "%u", list[i].stackUsed);
+        }
+        sprintf(line, "%3u %u/%u %-5s %3u%% %5s", list[i].pid, list[i].priority,
+                list[i].basePriority, stateNames[list[i].blockState], list[i].cpuLoad,
+                stack);
+        shellPrint(line);
+    }
+}
+
+/*
+ * @brief   Lists every bound mailbox
+ */
+static void shellMbox(void)
+{
+    MailBoxInfo list[SHELL_ROWS];
+    char line[MESSAGE_SYS_LIMIT];
+    int count = getMailBoxList(list, SHELL_ROWS);
+    int i;
+
+    shellPrint(" MB PID DEPTH PEAK SENDS");
+    for(i = 0; i < count; i++)
+    {
+        sprintf(line, "%3d %3u %5d %4d %lu", list[i].index, list[i].ownerPid,
+                list[i].depth, list[i].peakDepth, list[i].sends);
+        shellPrint(line);
+    }
+}
+
+/*
+ * @brief   Writes one pool's counts
+ * @param   [in] char* name: name of the pool
+ *          [in] PoolCount* pool: counts of the pool
+ */
+static void shellPoolLine(char * name, PoolCount * pool)
+{
+    char line[MESSAGE_SYS_LIMIT];
+
+    sprintf(line, "%-4s %4d %5d %3d", name, pool->free, pool->total, pool->lowWater);
+    shellPrint(line);
+}
+
+/*
+ * @brief   Lists the free, total and low water counts of the message
+ *          header, payload and receive log pools
+ */
+static void shellPool(void)
+{
+    PoolInfo info;
+
+    getPoolInfo(&info);
+    shellPrint("POOL FREE TOTAL LOW");
+    shellPoolLine("MSG", &info.messages);
+    shellPoolLine("BUF", &info.buffers);
+    shellPoolLine("LOG", &info.logs);
+}
+
+/*
+ * @brief   Shows the kernel tick and the user timer
+ */
+static void shellTimers(void)
+{
+    TimerInfo info;
+    char line[MESSAGE_SYS_LIMIT];
+
+    getTimerInfo(&info);
+    sprintf(line, "TICKS  %lu", info.ticks);
+    shellPrint(line);
+    sprintf(line, "PERIOD %lu", info.period);
+    shellPrint(line);
+    sprintf(line, "TIMER  %s %d", (info.timerSet)? "SET" : "IDLE", info.remaining);
+    shellPrint(line);
+}
+
+/*
+ * @brief   Shows the data link traffic counters
+ */
+static void shellLink(void)
+{
+    DLCounters counters;
+    char line[MESSAGE_SYS_LIMIT];
+
+    getDataLinkCounters(&counters);
+    shellPrint("      SENT  RECEIVED");
+    sprintf(line, "FRAME %-5lu %lu", counters.framesSent, counters.framesReceived);
+    shellPrint(line);
+    sprintf(line, "ACK   %-5lu %lu", counters.acksSent, counters.acksReceived);
+    shellPrint(line);
+    sprintf(line, "NACK  %-5lu %lu", counters.nacksSent, counters.nacksReceived);
+    shellPrint(line);
+    sprintf(line, "RETX  %lu", counters.retransmitted);
+    shellPrint(line);
+}
+
+/*
+ * @brief   Dumps the kernel trace ring, one record per APC string,
+ *          no faster than the output server can draw them
+ */
+static void shellTrace(void)
+{
+    TraceRecord records[SHELL_TRACE_BATCH];
+    char apc[MESSAGE_SYS_LIMIT];
+    char line[MESSAGE_SYS_LIMIT];
+    unsigned char * bytes;
+    int start = 0;
+    int count;
+    int i;
+    int j;
+
+    sendApc(shellMB, TRACE_APC_START TRACE_APC_END);
+
+    while((count = getTrace(records, start, SHELL_TRACE_BATCH)) > 0)
+    {
+        for(i = 0; i < count; i++)
+        {
+            strcpy(apc, TRACE_APC_START);
+            bytes = (unsigned char *)&records[i];
+            for(j = 0; j < (int)sizeof(TraceRecord); j++)
+            {
+                sprintf(apc + strlen(apc), "%02X", bytes[j]);
+            }
+            strcat(apc, TRACE_APC_END);
+            sendApc(shellMB, apc);
+        }
+        start += count;
+    }
+
+    sprintf(line, "TRACE %d RECORDS", start);
+    shellPrint(line);
+}
+
+/*
+ * @brief   Lists the hops correlated work has made, with the histogram
+ *          buckets holding its median and slowest arrivals
+ */
+static void shellHops(void)
+{
+    HopStats stats;
+    char line[MESSAGE_SYS_LIMIT];
+    unsigned long seen;
+    int hop;
+    int median;
+    int slowest;
+
+    shellPrint("HOP    COUNT P50 MAX BUCKET");
+    for(hop = 0; hop < HOP_AMOUNT; hop++)
+    {
+        if((getHopStats(hop, &stats) != SUCCESS) || !stats.count)
+        {
+            continue;
+        }
+
+        seen = 0;
+        for(median = 0; (seen += stats.latency[median]) * 2 < stats.count; median++);
+        for(slowest = LATENCY_BUCKETS - 1; !stats.latency[slowest]; slowest--);
+
+        sprintf(line, "%s %2d %6lu %3d %3d", (hop < MAILBOX_AMOUNT)? "MB" : "CH",
+                (hop < MAILBOX_AMOUNT)? hop : hop - MAILBOX_AMOUNT, stats.count, median, slowest);
+        shellPrint(line);
+    }
+}
+
+/*Commands are matched against the uppercased line*/
+static ShellCommand commands[] = {
+    {"PS", shellPs},
+    {"MBOX", shellMbox},
+    {"POOL", shellPool},
+    {"TIMERS", shellTimers},
+    {"LINK", shellLink},
+    {"TRACE", shellTrace},
+    {"HOPS", shellHops}
+};
+
+#define SHELL_COMMANDS  ((int)(sizeof(commands) / sizeof(ShellCommand)))
+
+/*
+ * @brief   Shell process. Runs each command line forwarded by the UART0
+ *          input server and clears whatever the last reply left behind.
+ */
+void shellProcess(void)
+{
+    int senderMB;
+    int size;
+    char cmd[MESSAGE_SYS_LIMIT];
+    int lastRows = NULL;
+    int i;
+
+    shellMB = bindName(SHELL_NAME);
+    if(shellMB >= 0)
+    {
+        while(1)
+        {
+            size = MESSAGE_SYS_LIMIT - 1;
+            recvMessage(shellMB, &senderMB, cmd, &size);
+            cmd[size] = NUL;
+
+            shellRow = NULL;
+            for(i = 0; (i < SHELL_COMMANDS) && strcmp(cmd, commands[i].name); i++);
+
+            if(i < SHELL_COMMANDS)
+            {
+                commands[i].run();
+            }
+            else
+            {
+                shellPrint("PS MBOX POOL TIMERS LINK");
+                shellPrint("TRACE HOPS");
+            }
+
+            /* Blank rows the previous reply used */
+            i = shellRow;
+            while(shellRow < lastRows)
+            {
+                shellPrint("");
+            }
+            lastRows = i;
+        }
+    }
+
+    /* If this return statement is reached, the process terminates because
+     * mailbox bind or name registration was unsuccessful
+     */
+    return;
+}
@@ -0,0 +1,30 @@
+/*
+ * @file    Shell.h
+ * @brief   Contains the definitions used by the UART0 diagnostic shell
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#pragma once
+
+/* Name the shell's mailbox is registered under; the UART0 input
+ * server looks it up to forward shell lines
+ */
+#define SHELL_NAME      "shell"
+
+/* Lines typed starting with this character go to the shell */
+#define SHELL_PREFIX    '!'
+
+/* Terminal rows the shell writes its replies on */
+#define SHELL_FIRST_ROW 13
+#define SHELL_ROWS      12
+
+/* Trace records read per kernel call while dumping */
+#define SHELL_TRACE_BATCH   4
+
+#ifndef GLOBAL_SHELL
+#define GLOBAL_SHELL
+
+extern void shellProcess(void);
+
+#endif /* GLOBAL_SHELL */
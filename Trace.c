@@ -0,0 +1,90 @@
+/*
+ * @file    Trace.c
+ * @brief   Contains the kernel event trace ring. Records are written from
+ *          the kernel and ISRs with interrupts masked and read back
+ *          through a kernel call, oldest first.
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#include "SVC.h"
+#include "SYSTICK.h"
+#include "Utilities.h"
+#define GLOBAL_TRACE
+#include "Trace.h"
+
+#ifdef KERNEL_TRACE
+
+/*Trace records, indexed by traceCount modulo TRACE_DEPTH*/
+static TraceRecord traceRing[TRACE_DEPTH];
+
+/*Records written since start up*/
+static unsigned long traceCount = 0;
+
+/*Set while the ring is being read so the dump is not overwritten*/
+static int tracePaused = FALSE;
+
+/*
+ * @brief   Adds a record to the trace ring. Callable from ISRs and the
+ *          kernel; the interrupt mask is restored rather than cleared.
+ * @param   [in] int event: one of traceEvents
+ *          [in] unsigned int arg: event argument
+ */
+void traceRecord(int event, unsigned int arg)
+{
+    unsigned long mask = get_PRIMASK();
+    PCB * running;
+    TraceRecord * record;
+
+    disable();
+    if(!tracePaused)
+    {
+        running = getRunningPCB();
+        record = &traceRing[traceCount & (TRACE_DEPTH - 1)];
+        record->time = getKernelTime();
+        record->event = event;
+        record->pid = (running)? running->pid : TRACE_NO_PID;
+        record->arg = arg;
+        traceCount++;
+    }
+    set_PRIMASK(mask);
+}
+
+#endif /* KERNEL_TRACE */
+
+/*
+ * @brief   Copies out trace records, oldest first. Tracing stops when
+ *          reading starts at the oldest record and resumes once a read
+ *          finds nothing left, so a dump is not overwritten by its own
+ *          output.
+ * @param   [out] TraceRecord* records: where the records are copied
+ *          [in] int start: number of records already read
+ *          [in] int maxRecords: number of records available
+ * @return  int: number of records copied, 0 at the end or when tracing
+ *          is not built in
+ */
+int kernelGetTrace(TraceRecord * records, int start, int maxRecords)
+{
+    int count = 0;
+#ifdef KERNEL_TRACE
+    int held = (traceCount < TRACE_DEPTH)? traceCount : TRACE_DEPTH;
+    unsigned long oldest = traceCount - held;
+
+    if(start == 0)
+    {
+        tracePaused = TRUE;
+    }
+
+    while((start + count < held) && (count < maxRecords))
+    {
+        records[count] = traceRing[(oldest + start + count) & (TRACE_DEPTH - 1)];
+        count++;
+    }
+
+    if(count == 0)
+    {
+        tracePaused = FALSE;
+    }
+#endif
+    return count;
+}
@@ -0,0 +1,59 @@
+/*
+ * @file    Trace.h
+ * @brief   Contains the kernel event trace record and the TRACE macro.
+ *          Tracing is built in only when KERNEL_TRACE is predefined;
+ *          otherwise every TRACE point compiles to nothing.
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#pragma once
+#include "Process.h"
+
+/* Number of records held, a power of two. Oldest records are overwritten */
+#define TRACE_DEPTH     256
+
+/* pid recorded for events taken before any process runs */
+#define TRACE_NO_PID    0xFF
+
+/* Each record is dumped on UART0 as hex inside an APC string so a
+ * terminal ignores it while a host capture can pick it out. An empty
+ * string marks the start of a dump.
+ */
+#define TRACE_APC_START "\x1b_T"
+#define TRACE_APC_END   "\x1b\\"
+
+/* Traced events, arg given in brackets */
+enum traceEvents {TRACE_SWITCH,     /* pid switched from */
+                  TRACE_SEND,       /* destination mailbox index */
+                  TRACE_RECEIVE,    /* mailbox index */
+                  TRACE_BIND,       /* mailbox index */
+                  TRACE_BLOCK,      /* one of blockStates */
+                  TRACE_ISR_ENTRY,  /* one of inputQueue */
+                  TRACE_ISR_EXIT};  /* one of inputQueue */
+
+/* Structure of a trace record, 8 bytes in little endian order */
+typedef struct TraceRecord_
+{
+    /* getKernelTime() when the event was recorded */
+    unsigned long time;
+    unsigned char event;
+    /* Process running when the event was recorded */
+    unsigned char pid;
+    unsigned short arg;
+
+}TraceRecord;
+
+#ifdef KERNEL_TRACE
+#define TRACE(event, arg)   traceRecord((event), (arg))
+#else
+#define TRACE(event, arg)
+#endif
+
+#ifndef GLOBAL_TRACE
+#define GLOBAL_TRACE
+
+extern void traceRecord(int, unsigned int);
+extern int kernelGetTrace(TraceRecord *, int, int);
+
+#endif /* GLOBAL_TRACE */
@@ -70,6 +70,9 @@ struct TrainState
 };
 
 
+/* Mutex guarding TState and Switch_States, shared by both application layer handlers */
+#define TRAIN_STATE_MUTEX   (1)
+
 extern struct TrainState TState;
 extern unsigned char Switch_States;
 
@@ -19,93 +19,314 @@
 #include "Messages.h"
 #include "Queue.h"
 #include <ctype.h>
+#include <string.h>
 #include "PhysLayerMessage.h"
+#include "Channel.h"
+#include "Shell.h"
+#include "Trace.h"
+#include "Clock.h"
+#include "Compositor.h"
+#include "Log.h"
+
+/* UART0 line discipline; the line is collected in holding buffer 0 by
+ * the ISR. uart0_Line is set once ENTER ends it and cleared when the
+ * input server releases it, until then keystrokes go to the type ahead
+ */
+static char * volatile uart0_Line = NULL;
+static int uart0_LineLength = 0;
+static PCB * uart0_EchoPCB = NULL;
+static char uart0_TypeAhead[UART0_TYPEAHEAD];
+static unsigned long uart0_TypeHead = 0;
+static unsigned long uart0_TypeTail = 0;
+
+/* UART0 transmit ring; head is only advanced by uart0Put, tail only by the ISR */
+static char uart0_TransmitRing[UART0_TX_RING_SIZE];
+static volatile unsigned long uart0_TxHead = 0;
+static volatile unsigned long uart0_TxTail = 0;
+static volatile int uart0_TxWaiting = FALSE;
+
+/* UART1 frames; the ISR assembles into the slot at head and only
+ * advances it once the frame checks, the input server advances tail
+ */
+static PhysFrame uart1_Frames[UART1_RX_FRAMES];
+static volatile unsigned long uart1_FrameHead = 0;
+static volatile unsigned long uart1_FrameTail = 0;
+static int uart1_RxState = UART1_RX_HUNT;
+static unsigned char uart1_RxSum = 0;
 
-static interruptType uart0_ReceiveBuffer = {UART0,NUL};
-static interruptType uart1_ReceiveBuffer = {UART1,NUL};
-
-static int input0_Blocked = FALSE;
-static int input1_Blocked = FALSE;
+/* Output server batch and the text merged from consecutive entries */
+static MessageEntry outputBatch[UART0_OUTPUT_BATCH];
+static char outputText[(UART0_OUTPUT_BATCH * MESSAGE_SYS_LIMIT) + 1];
 
 
 //for accessing the processes horizontal possition
 
+/*
+ * @brief   Length of the text in a batch entry; senders may or may not
+ *          include the terminator in the size they send
+ * @param   [in] MessageEntry* entry: received message
+ * @return  int: characters before the terminator or the end of the message,
+ *          leaving room to terminate it in place
+ */
+static int entryLength(MessageEntry * entry)
+{
+    int length = 0;
+
+    while((length < entry->size) && (length < MESSAGE_SYS_LIMIT - 1) && entry->contents[length])
+    {
+        length++;
+    }
+    return length;
+}
+
+/*
+ * @brief   Gives back the credit an APC string was sent with
+ * @param   [in] MessageEntry* entry: entry that has been drawn or dropped
+ */
+static void returnApcCredit(MessageEntry * entry)
+{
+    if((entry->size > 1) && (entry->contents[0] == ESC) && (entry->contents[1] == APC))
+    {
+        semSignal(UART0_APC_SEM);
+    }
+}
+
+/*
+ * @brief   Sends an APC string to the UART0 output server, blocking
+ *          while UART0_APC_CREDITS strings are still waiting to be
+ *          drawn. A send refused for want of a pool payload is retried
+ *          after yielding, so the string is never lost.
+ * @param   [in] int mailbox: sending mailbox
+ * @param   [in] char* apc: terminated APC string
+ */
+void sendApc(int mailbox, char * apc)
+{
+    semWait(UART0_APC_SEM);
+    while(sendMessage(UART0_OP_MB, mailbox, apc, strlen(apc) + 1) != SUCCESS)
+    {
+        nice(getRunningPCB()->basePriority);
+    }
+}
+
+/*
+ * @brief   Hands a drained batch to the compositor. Runs of text from
+ *          the same mailbox are merged into one write, and an escape
+ *          sequence repeated back to back by the same sender is dropped.
+ *          APC strings carry data rather than terminal state so they
+ *          are always passed on.
+ * @param   [in] int count: entries in outputBatch
+ */
+static void drawOutputBatch(int count)
+{
+    int i = 0;
+    int length;
+    int from;
+    PCB * sender;
+
+    while(i < count)
+    {
+        from = outputBatch[i].from;
+        sender = getOwnerPCB(from);
+        length = entryLength(&outputBatch[i]);
+
+        /* Drop output from mailboxes that were unbound after sending */
+        if(!sender || !length)
+        {
+            returnApcCredit(&outputBatch[i]);
+            i++;
+        }
+        else if(outputBatch[i].contents[0] == ESC)
+        {
+            outputBatch[i].contents[length] = NUL;
+            if(!i || (outputBatch[i - 1].from != from) || (outputBatch[i].contents[1] == APC) ||
+               strcmp(outputBatch[i - 1].contents, outputBatch[i].contents))
+            {
+                compositorWrite(outputBatch[i].contents, sender);
+            }
+            returnApcCredit(&outputBatch[i]);
+            i++;
+        }
+        else
+        {
+            memcpy(outputText, outputBatch[i].contents, length);
+            i++;
+            while((i < count) && (outputBatch[i].from == from) &&
+                  (outputBatch[i].contents[0] != ESC))
+            {
+                memcpy(&outputText[length], outputBatch[i].contents, entryLength(&outputBatch[i]));
+                length += entryLength(&outputBatch[i]);
+                i++;
+            }
+            outputText[length] = NUL;
+            compositorWrite(outputText, sender);
+        }
+    }
+}
+
 /*
  * @brief uart process dedicated to outputing messages
- *        received from other processes
+ *        received from other processes. Everything queued is
+ *        drained in one trap and drawn into the compositor's
+ *        screen copy; the changes are sent at most once every
+ *        COMPOSITOR_FRAME_TICKS. The characters are queued for
+ *        the TX ISR so the server only blocks on a full ring
  */
 void uart0_OutputServer(void)
 {
     bind(UART0_OP_MB);
-    int toMB;
-    char cont[MESSAGE_SYS_LIMIT];
-    int size = MESSAGE_SYS_LIMIT;
+    int mailboxes[] = {UART0_OP_MB};
+    unsigned long ready;
+    int count;
+
+    compositorInit();
+    semInit(UART0_APC_SEM, UART0_APC_CREDITS);
     while(1)
     {
-        recvMessage(UART0_OP_MB, &toMB, cont, &size);
-        printStringUART0(cont, getOwnerPCB(toMB));
+        /* Only wake for the frame when there is something to send;
+         * until then an echoed keystroke is what makes there be
+         */
+        if(waitAny(mailboxes, 1, (compositorDirty())? SOURCE_FRAME : SOURCE_ECHO,
+                   &ready) == UART0_OP_MB)
+        {
+            count = recvBatch(UART0_OP_MB, outputBatch, UART0_OUTPUT_BATCH);
+            drawOutputBatch(count);
+        }
+
+        if(ready & SOURCE_FRAME)
+        {
+            compositorFlush();
+        }
+    }
+}
+
+/*
+ * @brief   Runs one received character through the UART0 line
+ *          discipline. Printable characters are stored and echoed,
+ *          BS removes and erases the last one and ENTER ends the line.
+ *          Called from the ISR, or with interrupts disabled.
+ * @param   [in] char data: character read from UART0
+ * @return  unsigned long: notification sources to signal
+ */
+static unsigned long uart0Discipline(char data)
+{
+    unsigned long sources = 0;
+
+    if(uart0_Line)
+    {
+        /* The last line hasn't been taken; hold the keystroke */
+        if((uart0_TypeHead - uart0_TypeTail) < UART0_TYPEAHEAD)
+        {
+            uart0_TypeAhead[uart0_TypeHead++ & UART0_TYPEAHEAD_MASK] = data;
+        }
+        return 0;
+    }
+
+    switch(data)
+    {
+    case ENTER:
+        uart0_Line = emptyBuffer_0();
+        sources = SOURCE_UART0_LINE;
+        break;
+    case BS:
+        if(removeFromBuffer_0() == SUCCESS)
+        {
+            uart0_LineLength--;
+            if(uart0_EchoPCB && compositorEcho(data, uart0_EchoPCB))
+            {
+                sources = SOURCE_ECHO;
+            }
+        }
+        break;
+    default:
+        /* One place is kept for the terminator */
+        if(isprint((unsigned char)data) && (uart0_LineLength < MAX_BUFFER - 1) &&
+           (addToBuffer_0(toupper(data)) == SUCCESS))
+        {
+            uart0_LineLength++;
+            if(uart0_EchoPCB && compositorEcho(data, uart0_EchoPCB))
+            {
+                sources = SOURCE_ECHO;
+            }
+        }
     }
+    return sources;
 }
 
-int get_UART0_InputState(void)
+/*
+ * @brief   Hands the finished line back to the line discipline and
+ *          runs any keystrokes typed ahead through it
+ */
+static void uart0ReleaseLine(void)
 {
-    return input0_Blocked;
+    unsigned long sources = 0;
+
+    disable();
+    uart0_Line = NULL;
+    uart0_LineLength = 0;
+    while(!uart0_Line && (uart0_TypeTail != uart0_TypeHead))
+    {
+        sources |= uart0Discipline(uart0_TypeAhead[uart0_TypeTail++ & UART0_TYPEAHEAD_MASK]);
+    }
+    if(sources)
+    {
+        signalSource(sources);
+    }
+    enable();
 }
 
+/*
+ * @brief uart process dedicated to handing lines of input to
+ *        processes that send it a prompt. Keystrokes are echoed and
+ *        edited by the UART0 ISR, which only wakes the server once a
+ *        line is finished; it is held until a process asks for it.
+ *        Lines starting with SHELL_PREFIX go to the shell instead.
+ */
 void uart0_InputServer(void)
 {
     bind(UART0_IP_MB);
-    int myID = getid();
-    int inputEntered;
-    interruptType inputBuffer ={UART0,NUL};
-    char * cmd;
-    int toMB;
+    int mailboxes[] = {UART0_IP_MB};
+    unsigned long ready;
+    int toMB = ANY;
+    int shellMB = NAME_FAIL;
     char cont[MESSAGE_SYS_LIMIT];
-    int size = MESSAGE_SYS_LIMIT;
+    int recvSize;
+
+    /* Echo is drawn at this process's cursor, like its prompts */
+    uart0_EchoPCB = getRunningPCB();
     while (1)
     {
-        recvMessage(UART0_IP_MB, &toMB, cont, &size);
-        sendMessage(UART0_OP_MB, UART0_IP_MB, cont, size);
-        cmd = NULL;
-        size = NULL;
-        inputEntered = FALSE;
-        while (!inputEntered)
+        /* Take a new prompt only once the last one has its line, and
+         * leave keystrokes typed ahead while a finished line is held
+         */
+        if (waitAny(mailboxes, (toMB == ANY)? 1 : 0,
+                    (uart0_Line)? 0 : SOURCE_UART0_LINE, &ready) == UART0_IP_MB)
         {
-            if (dequeue(&inputBuffer))
-            {
-                switch (inputBuffer.data)
-                {
-                case ENTER:
-
-                    cmd = emptyBuffer_0();
-                    inputEntered = TRUE;
-                    sendMessage(toMB, UART0_IP_MB, cmd, size);
-
-                    break;
-                case BS:
-
-                    if (removeFromBuffer_0() == SUCCESS)
-                    {
-                        sendMessage(UART0_OP_MB, UART0_IP_MB, &inputBuffer.data, CHAR_SEND);
-                    }
-
-                    break;
-                default:
-                    if (addToBuffer_0(toupper(inputBuffer.data)) == SUCCESS)
-                    {
-                        sendMessage(UART0_OP_MB, UART0_IP_MB, &inputBuffer.data, CHAR_SEND);
-                        size++;
-                    }
-                }
-            }
-            else
+            recvSize = MESSAGE_SYS_LIMIT;
+            recvMessage(UART0_IP_MB, &toMB, cont, &recvSize);
+            sendMessage(UART0_OP_MB, UART0_IP_MB, cont, recvSize);
+        }
+
+        /* Shell lines are handed over without the prefix and leave any
+         * pending prompt waiting for its own line
+         */
+        if (uart0_Line && (uart0_Line[0] == SHELL_PREFIX))
+        {
+            /* The shell registers after this server starts, so it is
+             * looked up with the first line for it
+             */
+            if (shellMB == NAME_FAIL)
             {
-                input0_Blocked = TRUE;
-                block();
-                input0_Blocked = FALSE;
+                shellMB = lookupName(SHELL_NAME);
             }
+            sendMessage(shellMB, UART0_IP_MB, uart0_Line + 1, uart0_LineLength);
+            uart0ReleaseLine();
+        }
+        else if (uart0_Line && (toMB != ANY))
+        {
+            sendMessage(toMB, UART0_IP_MB, uart0_Line, uart0_LineLength);
+            toMB = ANY;
+            uart0ReleaseLine();
         }
-
     }
 }
 
@@ -118,108 +339,95 @@ void uart0_InputServer(void)
  */
 void uart1_OutputServer(void)
 {
-    bind(UART1_OP_MB);
-    int toMB;
-    char cont[MESSAGE_SYS_LIMIT];
-    int size = MESSAGE_SYS_LIMIT;
-    while(1)
+    char frame[PHYS_FRAME_SIZE];
+    int size;
+    Channel * fromPhys = channelOpen(PHYS_UART1_CHANNEL, PHYS_FRAME_SIZE, PHYS_CHANNEL_DEPTH);
+
+    while(fromPhys)
     {
-        size = MESSAGE_SYS_LIMIT;
-        recvMessage(UART1_OP_MB, &toMB, cont, &size);
-        printStringUART1(cont, size);
+        /* Frames are taken straight from the physical layer's ring; the
+         * kernel is only entered when the ring runs dry
+         */
+        size = channelReceive(fromPhys, frame);
+        printStringUART1(frame, size);
     }
 }
 
-int get_UART1_InputState(void)
-{
-    return input1_Blocked;
-}
-
+/*
+ * @brief   uart process delivering the frames assembled by the UART1
+ *          receive ISR straight to the data link layer
+ */
 void uart1_InputServer(void)
 {
+    PhysFrame * frame;
+    unsigned long ready;
+
     bind(UART1_IP_MB);
-    int myID = getid();
-    int inputEntered;
-    interruptType inputBuffer ={UART1,NUL};
-    char * cmd;
-    int toMB;
-    char cont[MESSAGE_SYS_LIMIT];
-    int size = MESSAGE_SYS_LIMIT;
     while (1)
     {
-        cmd = NULL;
-        size = NULL;
-        inputEntered = FALSE;
-        while (!inputEntered)
+        if (uart1_FrameTail != uart1_FrameHead)
         {
-            if (dequeue(&inputBuffer))
-            {
-                switch (inputBuffer.data)
-                {
-                case ETX:
-
-                    cmd = emptyBuffer_1();
-                    inputEntered = TRUE;
-                    sendMessage(UART1PHYSMB, UART1_IP_MB, cmd, size);
-
-                    break;
-                default:
-                    if (addToBuffer_1(inputBuffer.data) == SUCCESS)
-                    {
-                        size++;
-                    }
-                }
-            }
-            else
-            {
-                input1_Blocked = TRUE;
-                block();
-                input1_Blocked = FALSE;
-            }
+            /* The checksum was verified by the ISR and is left off */
+            frame = &uart1_Frames[uart1_FrameTail & UART1_RX_MASK];
+            sendMessage(PHYSDATALINKMB, UART1_IP_MB, frame->bytes, frame->length - 1);
+            uart1_FrameTail++;
+        }
+        else
+        {
+            /* Sleep until the UART1 ISR completes another frame */
+            waitAny(NULL, 0, SOURCE_UART1_RX, &ready);
         }
-
     }
 }
+
 /*
  * @brief initialize UART0 and UART1
- *        with BAUD-RATE:       115200
+ *        with BAUD-RATE:       UART0_BAUD, UART1_BAUD
  *             Data Bits:       8
  *             Parity Bits:     0
  *             Stop Bits:       1
+ *             FIFOs:           enabled at UARTx_FIFO_LEVELS
  */
 void UART_Init(void)
 {
     volatile int wait;
+    unsigned long divisor;
 
     /* Initialize UART0/UART1 */
-    SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCUART_GPIO;   // Enable Clock Gating for UART0/UART1
-    SYSCTL_RCGCUART_R |= SYSCTL_RCGCGPIO_UART;   // Enable Clock Gating for PORTA/PORTB
+    REG_SET(SYSCTL_RCGCGPIO_R, SYSCTL_RCGCUART_GPIO);   // Enable Clock Gating for UART0/UART1
+    REG_SET(SYSCTL_RCGCUART_R, SYSCTL_RCGCGPIO_UART);   // Enable Clock Gating for PORTA/PORTB
     wait = 0; // give time for the clocks to activate
 
-    UART0_CTL_R &= ~UART_CTL_UARTEN;        // Disable the UART
-    UART1_CTL_R &= ~UART_CTL_UARTEN;
+    REG_CLEAR(UART0_CTL_R, UART_CTL_UARTEN);        // Disable the UART
+    REG_CLEAR(UART1_CTL_R, UART_CTL_UARTEN);
     wait = 0;   // wait required before accessing the UART config regs
 
-    // Setup the BAUD rate
-    UART0_IBRD_R = 8;   // IBRD = int(16,000,000 / (16 * 115,200)) = 8.680555555555556
-    UART0_FBRD_R = 44;  // FBRD = int(.680555555555556 * 64 + 0.5) = 44.05555555555556
+    // Setup the BAUD rate from the running system clock
+    // e.g. 120,000,000 / (16 * 115,200) = 65.104 -> IBRD = 65, FBRD = int(.104 * 64 + 0.5) = 7
+    divisor = UART_BAUD_DIVISOR(getSystemClock(), UART0_BAUD);
+    REG_WRITE(UART0_IBRD_R, divisor >> UART_FBRD_BITS);
+    REG_WRITE(UART0_FBRD_R, divisor & UART_FBRD_MASK);
+
+    divisor = UART_BAUD_DIVISOR(getSystemClock(), UART1_BAUD);
+    REG_WRITE(UART1_IBRD_R, divisor >> UART_FBRD_BITS);
+    REG_WRITE(UART1_FBRD_R, divisor & UART_FBRD_MASK);
 
-    UART1_IBRD_R = 8;
-    UART1_FBRD_R = 44;
+    REG_WRITE(UART0_LCRH_R, (UART_LCRH_WLEN_8 | UART_LCRH_FEN));  // WLEN: 8, no parity, one stop bit, with FIFOs
+    REG_WRITE(UART1_LCRH_R, (UART_LCRH_WLEN_8 | UART_LCRH_FEN));
 
-    UART0_LCRH_R = (UART_LCRH_WLEN_8);  // WLEN: 8, no parity, one stop bit, without FIFOs)
-    UART1_LCRH_R = (UART_LCRH_WLEN_8);
+    REG_WRITE(UART0_IFLS_R, UART0_FIFO_LEVELS);   // FIFO levels that raise RX and TX interrupts
+    REG_WRITE(UART1_IFLS_R, UART1_FIFO_LEVELS);
 
-    GPIO_PORTA_AFSEL_R = 0x3;        // Enable Receive and Transmit on PA1-0
-    GPIO_PORTA_PCTL_R = (0x01) | ((0x01) << 4);         // Enable UART RX/TX pins on PA1-0
-    GPIO_PORTA_DEN_R = EN_DIG_P0 | EN_DIG_P1;        // Enable Digital I/O on PA1-0
+    REG_WRITE(GPIO_PORTA_AFSEL_R, 0x3);        // Enable Receive and Transmit on PA1-0
+    REG_WRITE(GPIO_PORTA_PCTL_R, (0x01) | ((0x01) << 4));         // Enable UART RX/TX pins on PA1-0
+    REG_WRITE(GPIO_PORTA_DEN_R, EN_DIG_P0 | EN_DIG_P1);        // Enable Digital I/O on PA1-0
 
-    GPIO_PORTB_AFSEL_R = 0x3;
-    GPIO_PORTB_PCTL_R = (0x01) | ((0x01) << 4);
-    GPIO_PORTB_DEN_R = EN_DIG_P0 | EN_DIG_P1;
+    REG_WRITE(GPIO_PORTB_AFSEL_R, 0x3);
+    REG_WRITE(GPIO_PORTB_PCTL_R, (0x01) | ((0x01) << 4));
+    REG_WRITE(GPIO_PORTB_DEN_R, EN_DIG_P0 | EN_DIG_P1);
 
-    UART0_CTL_R = UART_CTL_UARTEN;        // Enable the UART
-    UART1_CTL_R = UART_CTL_UARTEN;
+    REG_WRITE(UART0_CTL_R, UART_CTL_UARTEN);        // Enable the UART
+    REG_WRITE(UART1_CTL_R, UART_CTL_UARTEN);
     wait = 0; // wait; give UART time to enable itself.
 }
 
@@ -233,9 +441,9 @@ void InterruptEnable(unsigned long InterruptIndex)
 {
 /* Indicate to CPU which device is to interrupt */
 if(InterruptIndex < 32)
-    NVIC_EN0_R |= 1 << InterruptIndex;       // Enable the interrupt in the EN0 Register
+    REG_SET(NVIC_EN0_R, 1 << InterruptIndex);       // Enable the interrupt in the EN0 Register
 else
-    NVIC_EN1_R |= 1 << (InterruptIndex - 32);    // Enable the interrupt in the EN1 Register
+    REG_SET(NVIC_EN1_R, 1 << (InterruptIndex - 32));    // Enable the interrupt in the EN1 Register
 }
 
 /*
@@ -246,8 +454,8 @@ else
 void UARTIntEnable(unsigned long flags)
 {
     /* Set specified bits for interrupt */
-    UART0_IM_R |= flags;
-    UART1_IM_R |= flags;
+    REG_SET(UART0_IM_R, flags);
+    REG_SET(UART1_IM_R, flags);
 }
 
 /*
@@ -257,41 +465,61 @@ void UARTIntEnable(unsigned long flags)
  */
 void force_UART0_Output(char data)
 {
-        while(UART0_FR_R & UART_FR_TXFF);//wait until not busy
-        UART0_DR_R = data;
+        while(REG_READ(UART0_FR_R) & UART_FR_TXFF);//wait until not busy
+        REG_WRITE(UART0_DR_R, data);
 }
 
 /*
- * @brief   Force character into the data register
- * @param   [in] char data: character to be put into
- *          data register
+ * @brief   Queue a character for transmission by the UART0 TX ISR. While
+ *          the ring is empty characters go straight into the TX FIFO; once
+ *          the FIFO fills they are queued and the TX interrupt, raised as
+ *          the FIFO drains past its level, tops it up from the ring.
+ *          A process that finds the ring full blocks until the ISR has
+ *          drained UART0_TX_RESUME characters. Blocking is a kernel call,
+ *          so a caller with interrupts masked, or running in an exception
+ *          handler, has the character dropped instead.
+ * @param   [in] char data: character to be transmitted
  */
-void force_UART1_Output(char data)
+void uart0Put(char data)
 {
-        while(UART1_FR_R & UART_FR_TXFF);//wait until not busy
-        UART1_DR_R = data;
+    unsigned long mask = get_PRIMASK();
+    unsigned long ready;
+
+    disable();
+    while((uart0_TxHead - uart0_TxTail) == UART0_TX_RING_SIZE)
+    {
+        if(mask || get_IPSR())
+        {
+            set_PRIMASK(mask);
+            return;
+        }
+        uart0_TxWaiting = TRUE;
+        enable();
+        waitAny(NULL, 0, SOURCE_UART0_TX, &ready);
+        disable();
+    }
+
+    if((uart0_TxHead == uart0_TxTail) && !(REG_READ(UART0_FR_R) & UART_FR_TXFF))
+    {
+        REG_WRITE(UART0_DR_R, data);
+    }
+    else
+    {
+        uart0_TransmitRing[uart0_TxHead & UART0_TX_RING_MASK] = data;
+        uart0_TxHead++;
+    }
+    set_PRIMASK(mask);
 }
 
 /*
- * @brief   for printing from a string from process
- *
- * @param   [in] char* string: string to print
- *
+ * @brief   Force character into the data register
+ * @param   [in] char data: character to be put into
+ *          data register
  */
-void printStringUART0(char* string, PCB * printingProcess)
+void force_UART1_Output(char data)
 {
-    //check if its and escape sequence
-    char cursorPosition[CURSOR_STRING];
-    getProcessCursor(printingProcess, cursorPosition);
-    systemPrintString(cursorPosition);
-
-    int increaseCursor = (*string == ESC)? FALSE : TRUE;
-    while(*string)
-    {
-        force_UART0_Output(*(string++));
-        //update process cursor if not an escape sequence
-        printingProcess->xAxisCursorPosition+=increaseCursor;
-    }
+        while(REG_READ(UART1_FR_R) & UART_FR_TXFF);//wait until not busy
+        REG_WRITE(UART1_DR_R, data);
 }
 
 /*
@@ -306,7 +534,7 @@ void systemPrintString(char* string)
 {
     while(*string)
     {
-        force_UART0_Output(*(string++));
+        uart0Put(*(string++));
     }
 }
 
@@ -330,65 +558,164 @@ void printStringUART1(char* string, unsigned char size)
  * @brief   Handles receive and transmit interrupts
  *
  * @detail  check if receive interrupt has been set
- *          if it has set gotData in the input queue
- *          if the the output queue isn't empty force
- *          next available data out
+ *          if it has run the characters through the line discipline
+ *          if the transmit ring isn't empty send the
+ *          next queued character out
  */
 void UART0_IntHandler(void)
 {
 /*
  * Simplified UART ISR - handles receive and xmit interrupts
- * Application signalled when data received
+ * Application signalled when a line has been entered
  */
-    if(UART0_MIS_R & UART_INT_RX)
+    unsigned long sources;
+
+    TRACE(TRACE_ISR_ENTRY, UART0);
+
+    if(REG_READ(UART0_MIS_R) & (UART_INT_RX | UART_INT_RT))
     {
-        /* RECV done - clear interrupt and make char available to application */
-        UART0_ICR_R |= UART_INT_RX;
-        uart0_ReceiveBuffer.data = UART0_DR_R;
-        enqueue(uart0_ReceiveBuffer);
-        if(get_UART0_InputState())
+        /* RECV level or timeout - drain the FIFO through the line discipline */
+        REG_WRITE(UART0_ICR_R, (UART_INT_RX | UART_INT_RT));
+        sources = 0;
+        while(!(REG_READ(UART0_FR_R) & UART_FR_RXFE))
         {
-            setPendType(INPUT_0);
-            CALLPENDSV;
+            sources |= uart0Discipline(REG_READ(UART0_DR_R));
+        }
+        if(sources)
+        {
+            signalSource(sources);
         }
     }
 
-    if(UART0_MIS_R & UART_INT_TX)
+    if(REG_READ(UART0_MIS_R) & UART_INT_TX)
     {
-        UART0_ICR_R |= UART_INT_TX;
+        /* XMIT level reached - top up the FIFO from the ring */
+        REG_WRITE(UART0_ICR_R, UART_INT_TX);
+        while((uart0_TxHead != uart0_TxTail) && !(REG_READ(UART0_FR_R) & UART_FR_TXFF))
+        {
+            REG_WRITE(UART0_DR_R, uart0_TransmitRing[uart0_TxTail & UART0_TX_RING_MASK]);
+            uart0_TxTail++;
+        }
+
+        /* Wake the output server once enough of the ring has drained */
+        if(uart0_TxWaiting &&
+           (UART0_TX_RING_SIZE - (uart0_TxHead - uart0_TxTail)) >= UART0_TX_RESUME)
+        {
+            uart0_TxWaiting = FALSE;
+            signalSource(SOURCE_UART0_TX);
+        }
     }
 
+    TRACE(TRACE_ISR_EXIT, UART0);
+}
+
+/*
+ * @brief   Runs one received byte through the UART1 frame state machine.
+ *          STX always starts a new frame, so a lost ETX or line noise
+ *          costs at most the frame it lands in. DLE escapes the byte
+ *          after it and ETX ends the frame, whose bytes, checksum
+ *          included, must sum to PHYS_CHECKSUM_SUM.
+ * @param   [in] char c: byte read from UART1
+ * @return  int: TRUE if a checked frame is ready for the input server
+ */
+static int uart1Assemble(char c)
+{
+    PhysFrame * frame = &uart1_Frames[uart1_FrameHead & UART1_RX_MASK];
+
+    if(c == STX && uart1_RxState != UART1_RX_ESCAPE)
+    {
+        if((uart1_FrameHead - uart1_FrameTail) == UART1_RX_FRAMES)
+        {
+            /* No slot to assemble into; drop this frame */
+            LOG(LOG_FRAME_OVERRUN, UART1_RX_FRAMES, 0);
+            uart1_RxState = UART1_RX_HUNT;
+        }
+        else
+        {
+            frame->length = 0;
+            uart1_RxSum = 0;
+            uart1_RxState = UART1_RX_DATA;
+        }
+        return FALSE;
+    }
+
+    switch(uart1_RxState)
+    {
+    case UART1_RX_HUNT:
+        /* Garbage between frames */
+        return FALSE;
+    case UART1_RX_DATA:
+        if(c == DLE)
+        {
+            uart1_RxState = UART1_RX_ESCAPE;
+            return FALSE;
+        }
+        if(c == ETX)
+        {
+            uart1_RxState = UART1_RX_HUNT;
+            if((frame->length > 1) && (uart1_RxSum == PHYS_CHECKSUM_SUM))
+            {
+                uart1_FrameHead++;
+                return TRUE;
+            }
+            if(frame->length)
+            {
+                LOG(LOG_CHECKSUM_FAIL, frame->length - 1, (unsigned char)frame->bytes[frame->length - 1]);
+            }
+            return FALSE;
+        }
+        break;
+    default:
+        uart1_RxState = UART1_RX_DATA;
+        break;
+    }
+
+    if(frame->length == PHYS_PAYLOAD_SIZE)
+    {
+        /* Longer than any frame sent; hunt for the next STX */
+        uart1_RxState = UART1_RX_HUNT;
+        return FALSE;
+    }
+    frame->bytes[frame->length++] = c;
+    uart1_RxSum += c;
+    return FALSE;
 }
 
 /*
  * @brief   Handles receive and transmit interrupts for UART1
- * @detail  check if receive interrupt has been set
- *          if it has set gotData in the input queue
- *          if the the output queue isn't empty force
- *          next available data out
+ * @detail  check if receive interrupt has been set; received
+ *          bytes are assembled into frames and the input server
+ *          is signalled once per interrupt that completed one
  */
 void UART1_IntHandler(void)
 {
 /*
  * Simplified UART ISR - handles receive and xmit interrupts
- * Application signalled when data received
+ * Application signalled when a whole frame has been received
  */
-    if (UART1_MIS_R & UART_INT_RX)
+    int framed;
+
+    TRACE(TRACE_ISR_ENTRY, UART1);
+
+    if (REG_READ(UART1_MIS_R) & (UART_INT_RX | UART_INT_RT))
     {
-        /* RECV done - clear interrupt and make char available to application */
-        UART1_ICR_R |= UART_INT_RX;
-        uart1_ReceiveBuffer.data = UART0_DR_R;
-        enqueue(uart1_ReceiveBuffer);
-        if (get_UART1_InputState())
+        /* RECV level or timeout - drain the FIFO and make chars available to application */
+        REG_WRITE(UART1_ICR_R, (UART_INT_RX | UART_INT_RT));
+        framed = FALSE;
+        while(!(REG_READ(UART1_FR_R) & UART_FR_RXFE))
+        {
+            framed |= uart1Assemble(REG_READ(UART1_DR_R));
+        }
+        if(framed)
         {
-            setPendType(INPUT_1);
-            CALLPENDSV;
+            signalSource(SOURCE_UART1_RX);
         }
     }
 
-    if(UART1_MIS_R & UART_INT_TX)
+    if(REG_READ(UART1_MIS_R) & UART_INT_TX)
     {
-        UART1_ICR_R |= UART_INT_TX;
+        REG_WRITE(UART1_ICR_R, UART_INT_TX);
     }
 
+    TRACE(TRACE_ISR_EXIT, UART1);
 }
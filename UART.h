@@ -11,44 +11,53 @@
  */
 #pragma once
 #include "Process.h"
-#define GPIO_PORTA_AFSEL_R  (*((volatile unsigned long *)0x40058420))   // GPIOA Alternate Function Select Register
-#define GPIO_PORTA_DEN_R    (*((volatile unsigned long *)0x4005851C))   // GPIOA Digital Enable Register
-#define GPIO_PORTA_PCTL_R   (*((volatile unsigned long *)0x4005852C))   // GPIOA Port Control Register
-
-#define GPIO_PORTB_AFSEL_R  (*((volatile unsigned long *)0x40059420))   // GPIOB Alternate Function Select Register
-#define GPIO_PORTB_DEN_R    (*((volatile unsigned long *)0x4005951C))   // GPIOB Digital Enable Register
-#define GPIO_PORTB_PCTL_R   (*((volatile unsigned long *)0x4005952C))   // GPIOB Port Control Register
-
-#define UART0_DR_R          (*((volatile unsigned long *)0x4000C000))   // UART0 Data Register
-#define UART0_FR_R          (*((volatile unsigned long *)0x4000C018))   // UART0 Flag Register
-#define UART0_IBRD_R        (*((volatile unsigned long *)0x4000C024))   // UART0 Integer Baud-Rate Divisor Register
-#define UART0_FBRD_R        (*((volatile unsigned long *)0x4000C028))   // UART0 Fractional Baud-Rate Divisor Register
-#define UART0_LCRH_R        (*((volatile unsigned long *)0x4000C02C))   // UART0 Line Control Register
-#define UART0_CTL_R         (*((volatile unsigned long *)0x4000C030))   // UART0 Control Register
-#define UART0_IFLS_R        (*((volatile unsigned long *)0x4000C034))   // UART0 Interrupt FIFO Level Select Register
-#define UART0_IM_R          (*((volatile unsigned long *)0x4000C038))   // UART0 Interrupt Mask Register
-#define UART0_MIS_R         (*((volatile unsigned long *)0x4000C040))   // UART0 Masked Interrupt Status Register
-#define UART0_ICR_R         (*((volatile unsigned long *)0x4000C044))   // UART0 Interrupt Clear Register
-#define UART0_CC_R          (*((volatile unsigned long *)0x4000CFC8))   // UART0 Clock Control Register
-
-#define UART1_DR_R          (*((volatile unsigned long *)0x4000D000))   // UART1 Data Register
-#define UART1_FR_R          (*((volatile unsigned long *)0x4000D018))   // UART1 Flag Register
-#define UART1_IBRD_R        (*((volatile unsigned long *)0x4000D024))   // UART1 Integer Baud-Rate Divisor Register
-#define UART1_FBRD_R        (*((volatile unsigned long *)0x4000D028))   // UART1 Fractional Baud-Rate Divisor Register
-#define UART1_LCRH_R        (*((volatile unsigned long *)0x4000D02C))   // UART1 Line Control Register
-#define UART1_CTL_R         (*((volatile unsigned long *)0x4000D030))   // UART1 Control Register
-#define UART1_IFLS_R        (*((volatile unsigned long *)0x4000D034))   // UART1 Interrupt FIFO Level Select Register
-#define UART1_IM_R          (*((volatile unsigned long *)0x4000D038))   // UART1 Interrupt Mask Register
-#define UART1_MIS_R         (*((volatile unsigned long *)0x4000D040))   // UART1 Masked Interrupt Status Register
-#define UART1_ICR_R         (*((volatile unsigned long *)0x4000D044))   // UART1 Interrupt Clear Register
-#define UART1_CC_R          (*((volatile unsigned long *)0x4000DFC8))   // UART1 Clock Control Register
+#include "Registers.h"
+#define GPIO_PORTA_AFSEL_R  REGISTER(0x40058420)   // GPIOA Alternate Function Select Register
+#define GPIO_PORTA_DEN_R    REGISTER(0x4005851C)   // GPIOA Digital Enable Register
+#define GPIO_PORTA_PCTL_R   REGISTER(0x4005852C)   // GPIOA Port Control Register
+
+#define GPIO_PORTB_AFSEL_R  REGISTER(0x40059420)   // GPIOB Alternate Function Select Register
+#define GPIO_PORTB_DEN_R    REGISTER(0x4005951C)   // GPIOB Digital Enable Register
+#define GPIO_PORTB_PCTL_R   REGISTER(0x4005952C)   // GPIOB Port Control Register
+
+#define UART0_DR_R          REGISTER(0x4000C000)   // UART0 Data Register
+#define UART0_FR_R          REGISTER(0x4000C018)   // UART0 Flag Register
+#define UART0_IBRD_R        REGISTER(0x4000C024)   // UART0 Integer Baud-Rate Divisor Register
+#define UART0_FBRD_R        REGISTER(0x4000C028)   // UART0 Fractional Baud-Rate Divisor Register
+#define UART0_LCRH_R        REGISTER(0x4000C02C)   // UART0 Line Control Register
+#define UART0_CTL_R         REGISTER(0x4000C030)   // UART0 Control Register
+#define UART0_IFLS_R        REGISTER(0x4000C034)   // UART0 Interrupt FIFO Level Select Register
+#define UART0_IM_R          REGISTER(0x4000C038)   // UART0 Interrupt Mask Register
+#define UART0_MIS_R         REGISTER(0x4000C040)   // UART0 Masked Interrupt Status Register
+#define UART0_ICR_R         REGISTER(0x4000C044)   // UART0 Interrupt Clear Register
+#define UART0_CC_R          REGISTER(0x4000CFC8)   // UART0 Clock Control Register
+
+#define UART1_DR_R          REGISTER(0x4000D000)   // UART1 Data Register
+#define UART1_FR_R          REGISTER(0x4000D018)   // UART1 Flag Register
+#define UART1_IBRD_R        REGISTER(0x4000D024)   // UART1 Integer Baud-Rate Divisor Register
+#define UART1_FBRD_R        REGISTER(0x4000D028)   // UART1 Fractional Baud-Rate Divisor Register
+#define UART1_LCRH_R        REGISTER(0x4000D02C)   // UART1 Line Control Register
+#define UART1_CTL_R         REGISTER(0x4000D030)   // UART1 Control Register
+#define UART1_IFLS_R        REGISTER(0x4000D034)   // UART1 Interrupt FIFO Level Select Register
+#define UART1_IM_R          REGISTER(0x4000D038)   // UART1 Interrupt Mask Register
+#define UART1_MIS_R         REGISTER(0x4000D040)   // UART1 Masked Interrupt Status Register
+#define UART1_ICR_R         REGISTER(0x4000D044)   // UART1 Interrupt Clear Register
+#define UART1_CC_R          REGISTER(0x4000DFC8)   // UART1 Clock Control Register
 
 #define INT_VEC_UART0           5           // UART0 Rx and Tx interrupt index (decimal)
 #define INT_VEC_UART1           6           // UART1 Rx and Tx interrupt index (decimal)
 #define UART_FR_TXFF            0x00000020  // UART Transmit FIFO Full
 #define UART_FR_RXFE            0x00000010  // UART Receive FIFO Empty
-#define UART_RX_FIFO_ONE_EIGHT  0x00000038  // UART Receive FIFO Interrupt Level at >= 1/8
-#define UART_TX_FIFO_SVN_EIGHT  0x00000007  // UART Transmit FIFO Interrupt Level at <= 7/8
+#define UART_FIFO_RX1_8         0x00000000  // UART Receive FIFO Interrupt Level at >= 1/8 full
+#define UART_FIFO_RX2_8         0x00000008  // UART Receive FIFO Interrupt Level at >= 1/4 full
+#define UART_FIFO_RX4_8         0x00000010  // UART Receive FIFO Interrupt Level at >= 1/2 full
+#define UART_FIFO_RX6_8         0x00000018  // UART Receive FIFO Interrupt Level at >= 3/4 full
+#define UART_FIFO_RX7_8         0x00000020  // UART Receive FIFO Interrupt Level at >= 7/8 full
+#define UART_FIFO_TX1_8         0x00000000  // UART Transmit FIFO Interrupt Level at <= 1/8 full
+#define UART_FIFO_TX2_8         0x00000001  // UART Transmit FIFO Interrupt Level at <= 1/4 full
+#define UART_FIFO_TX4_8         0x00000002  // UART Transmit FIFO Interrupt Level at <= 1/2 full
+#define UART_FIFO_TX6_8         0x00000003  // UART Transmit FIFO Interrupt Level at <= 3/4 full
+#define UART_FIFO_TX7_8         0x00000004  // UART Transmit FIFO Interrupt Level at <= 7/8 full
 #define UART_LCRH_WLEN_8        0x00000060  // 8 bit word length
 #define UART_LCRH_FEN           0x00000010  // UART Enable FIFOs
 #define UART_CTL_UARTEN         0x00000301  // UART RX/TX Enable
@@ -62,23 +71,59 @@
 #define EN_DIG_P1              0x00000002  // Enable Digital I/O on PA1/PB1
 
 // Clock Gating Registers
-#define SYSCTL_RCGCGPIO_R      (*((volatile unsigned long *)0x400FE608))
-#define SYSCTL_RCGCUART_R      (*((volatile unsigned long *)0x400FE618))
+#define SYSCTL_RCGCGPIO_R      REGISTER(0x400FE608)
+#define SYSCTL_RCGCUART_R      REGISTER(0x400FE618)
 
 #define SYSCTL_RCGCGPIO_UART      0x00000003   // UART0 and UART1 Clock Gating Control
 #define SYSCTL_RCGCUART_GPIO      0x00000003   // Port A and B Clock Gating Control
 
-// Clock Configuration Register
-#define SYSCTRL_RCC_R           (*((volatile unsigned long *)0x400FE0B0))
+#define NVIC_EN0_R      REGISTER(0xE000E100)   // Interrupt 0-31 Set Enable Register
+#define NVIC_EN1_R      REGISTER(0xE000E104)   // Interrupt 32-54 Set Enable Register
 
-#define CLEAR_USRSYSDIV     0xF83FFFFF  // Clear USRSYSDIV Bits
-#define SET_BYPASS      0x00000800  // Set BYPASS Bit
 
-#define NVIC_EN0_R      (*((volatile unsigned long *)0xE000E100))   // Interrupt 0-31 Set Enable Register
-#define NVIC_EN1_R      (*((volatile unsigned long *)0xE000E104))   // Interrupt 32-54 Set Enable Register
+#define NUL 0x00
+#define APC '_'     // Second character of an Application Program Command string
 
+/* Line rates; divisors are computed from the system clock, which
+ * at 120 MHz allows UART1 to run at 460800 or 921600 as well
+ */
+#define UART0_BAUD          115200
+#define UART1_BAUD          115200
 
-#define NUL 0x00
+/* Baud divisor in 64ths: clock / (16 * baud), rounded to the nearest 64th */
+#define UART_BAUD_DIVISOR(clock, baud)  ((((clock) * 8 / (baud)) + 1) / 2)
+#define UART_FBRD_BITS      6
+#define UART_FBRD_MASK      0x3F
+
+/* FIFO trigger levels; anything short of the RX level arrives with the receive timeout */
+#define UART0_FIFO_LEVELS   (UART_FIFO_RX4_8 | UART_FIFO_TX2_8)
+#define UART1_FIFO_LEVELS   (UART_FIFO_RX4_8 | UART_FIFO_TX2_8)
+
+/* Messages the UART0 output server drains from its mailbox per trap */
+#define UART0_OUTPUT_BATCH  8
+
+/* APC strings (trace and log dumps) are paced by a counting semaphore;
+ * a sender takes a credit per string and the output server gives it
+ * back once the string is in the transmit ring
+ */
+#define UART0_APC_SEM       0
+#define UART0_APC_CREDITS   4
+
+/* UART0 transmit ring, filled by the output server and drained by the TX ISR */
+#define UART0_TX_RING_SIZE  256     // Must be a power of two
+#define UART0_TX_RING_MASK  (UART0_TX_RING_SIZE - 1)
+#define UART0_TX_RESUME     (UART0_TX_RING_SIZE / 2)    // Free slots before a blocked writer is woken
+
+/* Keystrokes held, unechoed, while a finished line waits for a prompt */
+#define UART0_TYPEAHEAD     64      // Must be a power of two
+#define UART0_TYPEAHEAD_MASK (UART0_TYPEAHEAD - 1)
+
+/* Frames the UART1 receive ISR holds for the input server */
+#define UART1_RX_FRAMES     4       // Must be a power of two
+#define UART1_RX_MASK       (UART1_RX_FRAMES - 1)
+
+/* UART1 receive states: waiting for STX, inside a frame, after a DLE */
+enum uart1RxStates {UART1_RX_HUNT, UART1_RX_DATA, UART1_RX_ESCAPE};
 
 
 
@@ -97,6 +142,10 @@ typedef struct CUP
     char nul;
 }Cursor;
 
+/* Writes a two digit position into a Cursor field without sprintf */
+#define CURSOR_DIGITS(field, value) ((field)[0] = '0' + (((value) / 10) % 10), \
+                                     (field)[1] = '0' + ((value) % 10))
+
 #ifndef GLOBAL_UART
 #define GLOBAL_UART
 
@@ -104,18 +153,21 @@ typedef struct CUP
     extern void UART_Init(void);
     extern void InterruptEnable(unsigned long);
     extern void UART_IntEnable(unsigned long);
+    extern void UARTIntEnable(unsigned long);
     extern void UART0_IntHandler(void);
     extern void UART1_IntHandler(void);
     extern void forceOutputUART0(char);
     extern int getDataRegister(char *);
     extern void printString(char*,PCB*);
     extern void systemPrintString(char*);
+    extern void uart0Put(char);
+    extern void sendApc(int, char*);
+    extern void printStringUART1(char*, unsigned char);
     extern void printWarning(int);
     extern void uart0_OutputServer(void);
     extern void uart0_InputServer(void);
     extern void uart1_OutputServer(void);
     extern void uart1_InputServer(void);
-    extern int get_UART0_InputState(void);
 
 
 
@@ -125,6 +177,7 @@ typedef struct CUP
     void forceOutput(char);
     void printString(char*,PCB*);
     void printWarning(int);
+    void printStringUART1(char*, unsigned char);
     void dataRecieved(void);
 
 #endif// GLOBAL_UART
@@ -10,7 +10,7 @@
  * @date    28-Nov-2019 (modified)
  */
 #define GLOBAL_UTILITIES
-#define TWO_DIGITS 10
+#define DECIMAL_DIGITS 10   //digits in the largest unsigned int
 
 #include "KernelCall.h"
 #include <stdlib.h>
@@ -19,6 +19,41 @@
 #include "SVC.h"
 #include "UART.h"
 #include <string.h>
+/*
+ * @brief   converts an unsigned value to a decimal string, zero
+ *          padded to a minimum width, without library support
+ *
+ * @param   [in] unsigned int val: value to be converted to a string
+ *          [in] int width: least number of digits written
+ *          [out] char* rtn: to return the nul terminated string
+ * @return  int: number of digits written
+ */
+int formatDecimal(unsigned int val, int width, char* rtn)
+{
+    char digits[DECIMAL_DIGITS];
+    int count = 0;
+    int i;
+
+    do
+    {
+        digits[count++] = '0' + (val % 10);
+        val /= 10;
+    } while(val);
+
+    while((count < width) && (count < DECIMAL_DIGITS))
+    {
+        digits[count++] = '0';
+    }
+
+    for(i = 0; i < count; i++)
+    {
+        rtn[i] = digits[count - 1 - i];
+    }
+    rtn[count] = NUL;
+
+    return count;
+}
+
 /*
  * @brief   adds a leading zero if a single digit number
  *          converts digit to a string
@@ -28,14 +63,7 @@
  */
 void formatLineNumber(int val, char* rtn)
 {
-    if(val<TWO_DIGITS)//only values less than ten have zeros added to the tens placement
-    {
-        sprintf(rtn,"0%d",val);
-    }
-    else
-    {
-        sprintf(rtn,"%d",val);
-    }
+    formatDecimal(val, POSITION_DIGITS, rtn);
 }
 
 /*
@@ -65,22 +93,36 @@ int myAtoi(int * num, char* str)
 }
 
 /*
- * @brief   formats cursor escape sequence with process id and
- *          horizontal process cursor position
+ * @brief   formats cursor escape sequence for a row and column
  *
- * @param   [in] int lineNumber: vertical value of cursor
+ * @param   [in] int line: vertical value of cursor
+ *          [in] int column: horizontal value of cursor
  *          [out] char* cursorString: to return the formatted cursor string
  */
-void getProcessCursor( PCB* printingProcess, char *cursorString)
+void formatCursor(int line, int column, char *cursorString)
 {
-    char printLine[POSITION_DIGITS];
-    char cursorPosition[POSITION_DIGITS];
+    Cursor * formattedString = (Cursor *)cursorString;
 
-    formatLineNumber(printingProcess->pid, printLine);
-    formatLineNumber(printingProcess->xAxisCursorPosition, cursorPosition);
-    Cursor formattedString = {ESC, '[',printLine[0] , printLine[1], ';', cursorPosition[0], cursorPosition[1], 'H',NUL};
-    memcpy(cursorString, (char*)&formattedString, CURSOR_STRING);
+    formattedString->esc = ESC;
+    formattedString->sqrbrkt = '[';
+    CURSOR_DIGITS(formattedString->line, line);
+    formattedString->semicolon = ';';
+    CURSOR_DIGITS(formattedString->col, column);
+    formattedString->cmdchar = 'H';
+    formattedString->nul = NUL;
+}
 
+/*
+ * @brief   formats cursor escape sequence with process row and
+ *          horizontal process cursor position
+ *
+ * @param   [in] PCB* printingProcess: process whose cursor is formatted
+ *          [out] char* cursorString: to return the formatted cursor string
+ */
+void getProcessCursor( PCB* printingProcess, char *cursorString)
+{
+    formatCursor(printingProcess->yAxisCursorPosition,
+                 printingProcess->xAxisCursorPosition, cursorString);
 }
 
 /*
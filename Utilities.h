@@ -8,11 +8,17 @@
  */
 #pragma     once
 #include "Process.h"
+#include "Registers.h"
 #include <stdio.h>
 #include <stdlib.h>
 
+#ifdef HOST_MODEL
+#define     disable()   //the host model takes interrupts one at a time
+#define     enable()
+#else
 #define     disable()   __asm(" cpsid i") //disable interrupts
 #define     enable()    __asm(" cpsie i")//enable interrupts
+#endif
 #define     ENTER       0x0d //ASCII Characters
 #define     BS          0x08
 #define     NUL         0x00
@@ -29,14 +35,32 @@
 #define     NULL        0
 #define     EMPTY       0       //Queue return values
 #define     FULL        0
-#define     ANY         16      //signals bind any
+#define     ANY         (-1)    //signals bind any
 #define     SEND_FAIL   -2      //Kernel Warnings
 #define     RECV_FAIL   -3
 #define     BIND_FAIL   -4
 #define     UNBIND_FAIL -5
+#define     TOPIC_FAIL  -6
+#define     NAME_FAIL   -7
+#define     WAIT_FAIL   -8
+#define     SOURCE_READY -9     //waitAny woken by a notification source
+#define     SYNC_FAIL   -10     //mutex and semaphore failures
+#define     SOURCE_UART0_LINE 0x01  //Notification sources signalled by ISRs
+#define     SOURCE_UART1_RX 0x02
+#define     SOURCE_TIMER    0x04
+#define     SOURCE_UART0_TX 0x08    //UART0 transmit ring has room again
+#define     SOURCE_FRAME    0x10    //Compositor frame period elapsed
+#define     SOURCE_LOG      0x20    //Log ring stopped being empty
+#define     SOURCE_ECHO     0x40    //Keystroke echoed into a clean screen
 #define     DEFAULT_FAIL FAILURE
 #define     MESSAGE_SYS_LIMIT 32
-#define     RECEIVE_LOG_AMOUNT MESSAGE_SYS_LIMIT
+#define     MESSAGE_PRIORITIES 3    //Message priorities, highest received first
+#define     MSG_PRIORITY_LOW    0
+#define     MSG_PRIORITY_NORMAL 1   //priority of sendMessage
+#define     MSG_PRIORITY_URGENT 2   //safety critical commands
+#define     MESSAGE_BUFFER_AMOUNT MESSAGE_SYS_LIMIT     //pooled message payloads
+#define     MESSAGE_HEADER_AMOUNT (2*MESSAGE_SYS_LIMIT) //queued messages, published fan-out shares payloads
+#define     RECEIVE_LOG_AMOUNT MESSAGE_HEADER_AMOUNT
 #define     UART0_OP_MB     0   //uart always mailbox 0
 #define     UART0_IP_MB     1
 #define     TIMER_MB       2
@@ -54,13 +78,15 @@
 #define     HALF_SECOND 50
 #define     CHAR_SEND 1
 #define     TIME_STRING     3   //time string length including nul
-#define     CALLPENDSV (*((volatile unsigned long *)0xE000ED04) |= 0x10000000UL)
+#define     CALLPENDSV REG_SET(NVIC_INT_CTRL_R, NVIC_INT_CTRL_PENDSVSET)
 
 
 #ifndef     GLOBAL_UTILITIES
 #define     GLOBAL_UTILITIES
 
+extern int formatDecimal(unsigned int, int, char*);
 extern void formatLineNumber(int,char*);
+extern void formatCursor(int, int, char*);
 extern void getProcessCursor(PCB*,char*);
 extern void printLineMarker(int, int);
 extern int myAtoi(int *, char*);
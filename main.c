@@ -16,39 +16,47 @@
 #include "AppLayerMessage.h"
 #include "DataLinkMessage.h"
 #include "PhysLayerMessage.h"
+#include "Shell.h"
+#include "IdleHook.h"
+#include "Clock.h"
+#include "Log.h"
 
 
 /*
  * @brief   definition of idleProcess; the first process registered
  *          by the kernel. It must always idle and will only be run
- *          if there are no other processes in place.
+ *          if there are no other processes in place. Runs the idle
+ *          hooks and prints a '*' every half second as a heartbeat.
  */
 void idleProcess(void)
 {
     /* Loop indefinitely */
 
     int mailBox = bind(ANY);
-    int myID = getid();
     PCB* runningPCB = getRunningPCB();
-    int k=0;
-    int wait;
+    Cursor lineStart;
+    unsigned long nextSymbol = getKernelTicks();
     int cursorPos = 0;
     while(1)
     {
-    while(cursorPos<IDLE_SYMBOLS)
-    {
-    sendMessage(UART0_OP_MB, mailBox, "*", CHAR_SEND);
-    while(k<500000)
-    {
-        wait =0;
-        k++;
-    }
-    k=0;
-    cursorPos++;
-    }
-    cursorPos=0;
-    runningPCB->xAxisCursorPosition=cursorPos;
-    sendMessage(UART0_OP_MB, mailBox, CLEAR_LINE, strlen(CLEAR_LINE) + 1);
+        runIdleHooks();
+
+        if((long)(getKernelTicks() - nextSymbol) >= 0)
+        {
+            nextSymbol += HALF_SECOND;
+            if(cursorPos<IDLE_SYMBOLS)
+            {
+                sendMessage(UART0_OP_MB, mailBox, "*", CHAR_SEND);
+                cursorPos++;
+            }
+            else
+            {
+                cursorPos=0;
+                formatCursor(runningPCB->yAxisCursorPosition, 1, (char *)&lineStart);
+                sendMessage(UART0_OP_MB, mailBox, &lineStart, sizeof(Cursor));
+                sendMessage(UART0_OP_MB, mailBox, CLEAR_LINE, strlen(CLEAR_LINE) + 1);
+            }
+        }
     }
 }
 
@@ -148,7 +156,14 @@ int main(void)
     registerResult |= registerProcess(DataLinkfromAppHandler, 7, 2);
     registerResult |= registerProcess(DataLinkfromPhysHandler, 8, 2);
     registerResult |= registerProcess(PhysLayerFromDLHandler, 9, 2);
-    registerResult |= registerProcess(PhysLayerFromUART1Handler, 10, 3);
+    registerResult |= registerProcess(shellProcess, 11, 1);
+    registerResult |= registerProcess(logDrainProcess, 12, 1);
+
+    /* Housekeeping left for the idle process */
+    registerIdleHook(idleScrubHook);
+    registerIdleHook(idlePaintHook);
+    registerIdleHook(idleHighWaterHook);
+    registerIdleHook(idleLoadHook);
 
 
     /* Register other test processes */
@@ -158,12 +173,13 @@ int main(void)
     if (!registerResult)
     {
         /* Initialize required hardware + interrupts */
+        Clock_Init();          // Run from the PLL before timing anything
         initpendSV();
         UART_Init();           // Initialize UART0
         InterruptEnable(INT_VEC_UART0);       // Enable UART0 interrupts
         InterruptEnable(INT_VEC_UART1);
-        UARTIntEnable(UART_INT_RX | UART_INT_TX); // Enable Receive and Transmit interrupts
-        SysTickPeriod(HUNDREDTH_WAIT);//HUNDREDTH_WAIT
+        UARTIntEnable(UART_INT_RX | UART_INT_RT | UART_INT_TX); // Enable Receive, Receive Timeout and Transmit interrupts
+        SysTickPeriod(HUNDREDTH_WAIT(getSystemClock()));
         SysTickIntEnable();
         systemPrintString(CLEAR_SCREEN);
 
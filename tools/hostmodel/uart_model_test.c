@@ -0,0 +1,189 @@
+/*
+ * @file    uart_model_test.c
+ * @brief   Runs the UART driver and ISRs against HostModel.c on the host.
+ *          The kernel calls the driver makes are replaced by stubs that
+ *          record what was asked of them; bytes are fed to and taken from
+ *          the modelled lines and interrupts taken with hostService.
+ * @author  Liam JA MacDonald
+ * @author  Patrick Wells
+ * @date    18-Oct-2026 (created)
+ */
+#include <stdio.h>
+#include <string.h>
+#include "Process.h"
+#include "Utilities.h"
+#include "UART.h"
+#include "Queue.h"
+#include "Clock.h"
+#include "Log.h"
+#include "KernelCall.h"
+#include "PhysLayerMessage.h"
+#include "HostModel.h"
+
+static int failures = 0;
+
+#define CHECK(cond)  do { if(!(cond)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); failures++; } } while(0)
+
+/* What the stubs were asked to do */
+static unsigned long signalled = 0;
+static int lastLog = -1;
+static int logCount = 0;
+
+/* Kernel and system calls the driver makes */
+void signalSource(unsigned long sources) { signalled |= sources; }
+void logWrite(int id, unsigned int arg1, unsigned int arg2) { lastLog = id; logCount++; }
+unsigned long getSystemClock(void) { return CLOCK_PLL_HZ; }
+void SYSTICKHandler(void) {}
+
+/* Only reached from the process side of the driver, which is not run here */
+PCB * getRunningPCB(void) { return NULL; }
+PCB * getOwnerPCB(int mailbox) { return NULL; }
+int waitAny(int * mailboxes, int count, unsigned long sources, unsigned long * ready) { return FAILURE; }
+int sendMessage(int to, int from, void * contents, int size) { return FAILURE; }
+int recvMessage(int mailbox, int * from, void * contents, int * size) { return FAILURE; }
+int recvBatch(int mailbox, MessageEntry * entries, int max) { return 0; }
+int nice(unsigned int priority) { return priority; }
+int lookupName(char * name) { return NAME_FAIL; }
+int semInit(int id, int count) { return SUCCESS; }
+int semWait(int id) { return SUCCESS; }
+int semSignal(int id) { return SUCCESS; }
+struct Channel_ * channelOpen(int id, int size, int depth) { return NULL; }
+int channelReceive(struct Channel_ * ch, void * data) { return 0; }
+
+/*
+ * @brief   Shifts a UART's line out, taking interrupts as the FIFO drains
+ * @return  int: bytes received by the far end
+ */
+static int drainLine(int uart, char * line, int max)
+{
+    int length = 0;
+    int data;
+
+    hostService();
+    while((data = hostUartTransmit(uart)) != HOST_LINE_IDLE)
+    {
+        if(length < max)
+        {
+            line[length++] = data;
+        }
+        hostService();
+    }
+    return length;
+}
+
+/*
+ * @brief   Feeds bytes to a UART's receive line, then lets it go idle
+ */
+static void receiveLine(int uart, const unsigned char * bytes, int count)
+{
+    int i;
+
+    for(i = 0; i < count; i++)
+    {
+        CHECK(hostUartReceive(uart, bytes[i]) == SUCCESS);
+        hostService();
+    }
+    hostUartReceiveTimeout(uart);
+    hostService();
+}
+
+/*
+ * @brief   Builds a physical layer frame the way PhysLayerFromDLHandler does
+ */
+static int buildFrame(const unsigned char * message, int size, unsigned char * frame)
+{
+    unsigned char checksum = 0;
+    int length = 0;
+    int i;
+
+    frame[length++] = STX;
+    for(i = 0; i <= size; i++)
+    {
+        unsigned char data = (i < size)? message[i] : (unsigned char)~checksum;
+        checksum += (i < size)? data : 0;
+        if((data == STX) || (data == ETX) || (data == DLE))
+        {
+            frame[length++] = DLE;
+        }
+        frame[length++] = data;
+    }
+    frame[length++] = ETX;
+    return length;
+}
+
+static void testUart0Transmit(void)
+{
+    char sent[UART0_TX_RING_SIZE];
+    char line[UART0_TX_RING_SIZE];
+    int i;
+
+    /* Longer than the FIFO, so the ring and TX interrupt carry the rest */
+    for(i = 0; i < 100; i++)
+    {
+        sent[i] = 'A' + (i % 26);
+        uart0Put(sent[i]);
+    }
+    CHECK(drainLine(UART0, line, sizeof(line)) == 100);
+    CHECK(!memcmp(sent, line, 100));
+}
+
+static void testUart0Receive(void)
+{
+    const unsigned char typed[] = {'a', 'b', BS, 'c'};
+    const unsigned char enter[] = {ENTER};
+
+    signalled = 0;
+    receiveLine(UART0, typed, sizeof(typed));
+    CHECK(!(signalled & SOURCE_UART0_LINE));
+
+    receiveLine(UART0, enter, sizeof(enter));
+    CHECK(signalled & SOURCE_UART0_LINE);
+}
+
+static void testUart1Receive(void)
+{
+    const unsigned char message[] = {0x41, STX, ETX, DLE, 0x42};
+    unsigned char frame[PHYS_FRAME_SIZE];
+    int length = buildFrame(message, sizeof(message), frame);
+
+    /* Garbage before the frame is skipped */
+    signalled = 0;
+    logCount = 0;
+    receiveLine(UART1, (const unsigned char *)"\x55\x03", 2);
+    receiveLine(UART1, frame, length);
+    CHECK(signalled & SOURCE_UART1_RX);
+    CHECK(logCount == 0);
+
+    /* A corrupted frame is dropped and logged */
+    signalled = 0;
+    frame[2] ^= 0x01;
+    receiveLine(UART1, frame, length);
+    CHECK(!(signalled & SOURCE_UART1_RX));
+    CHECK(lastLog == LOG_CHECKSUM_FAIL);
+}
+
+static void testUart1Transmit(void)
+{
+    char line[HOST_UART_FIFO_DEPTH];
+
+    printStringUART1("frame", 5);
+    CHECK(drainLine(UART1, line, sizeof(line)) == 5);
+    CHECK(!memcmp(line, "frame", 5));
+}
+
+int main(void)
+{
+    hostReset();
+    UART_Init();
+    InterruptEnable(INT_VEC_UART0);
+    InterruptEnable(INT_VEC_UART1);
+    UARTIntEnable(UART_INT_RX | UART_INT_RT | UART_INT_TX);
+
+    testUart0Transmit();
+    testUart0Receive();
+    testUart1Receive();
+    testUart1Transmit();
+
+    printf("%s\n", failures? "FAILED" : "passed");
+    return failures != 0;
+}
@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""
+@file    logdecode.py
+@brief   Expands the binary log shipped on UART0 by the log drain process.
+         Format strings are read from the LOG_MESSAGES table in Log.h, so
+         the header must match the firmware that produced the capture.
+@author  Liam JA MacDonald
+@author  Patrick Wells
+@date    18-Oct-2026 (created)
+
+usage: logdecode.py capture.log [--header Log.h] [--tick HZ]
+"""
+import argparse
+import os
+import re
+import struct
+import sys
+
+# Must match Log.h
+APC = re.compile(rb"\x1b_L([0-9A-Fa-f]{16})\x1b\\")
+RECORD = struct.Struct("<HBBHH")
+ENTRY = re.compile(r'X\(\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+SPECIFIER = re.compile(r"%[-0 #]*\d*[udxX]")
+DEFAULT_HEADER = os.path.join(os.path.dirname(__file__), "..", "Log.h")
+
+
+def load_formats(header):
+    """Returns the format strings of LOG_MESSAGES in id order"""
+    with open(header) as source:
+        text = source.read()
+    start = text.index("#define LOG_MESSAGES(X)")
+    table = text[start:text.index("\n\n", start)]
+    return [(name, fmt) for name, fmt in ENTRY.findall(table)]
+
+
+def expand(formats, ident, arg1, arg2):
+    if ident >= len(formats):
+        return "unknown message %d (%u, %u)" % (ident, arg1, arg2)
+    fmt = formats[ident][1]
+    args = (arg1, arg2)[:len(SPECIFIER.findall(fmt))]
+    return fmt % args
+
+
+def decode(capture, formats, tick):
+    """Yields (seconds, pid, text); the 16 bit tick count is unwrapped"""
+    offset = 0
+    last = None
+    for match in APC.finditer(capture):
+        ticks, ident, pid, arg1, arg2 = RECORD.unpack(bytes.fromhex(match.group(1).decode()))
+        if last is not None and ticks + offset < last:
+            offset += 1 << 16
+        last = ticks + offset
+        yield last / tick, pid, expand(formats, ident, arg1, arg2)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[2].strip())
+    parser.add_argument("capture", help="raw UART0 capture holding log records")
+    parser.add_argument("--header", default=DEFAULT_HEADER,
+                        help="Log.h the firmware was built with")
+    parser.add_argument("--tick", type=float, default=100,
+                        help="kernel ticks per second (default 100)")
+    args = parser.parse_args()
+
+    formats = load_formats(args.header)
+    with open(args.capture, "rb") as capture:
+        lines = list(decode(capture.read(), formats, args.tick))
+    if not lines:
+        sys.exit("no log records found in %s" % args.capture)
+
+    for seconds, pid, text in lines:
+        print("%10.2f pid %2d  %s" % (seconds, pid, text))
+
+
+if __name__ == "__main__":
+    main()
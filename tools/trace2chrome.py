@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""
+@file    trace2chrome.py
+@brief   Converts a kernel trace dumped on UART0 by the shell's trace
+         command into Chrome trace JSON (chrome://tracing or Perfetto).
+         The input is a raw capture of the UART0 output; the last dump
+         found in it is converted.
+@author  Liam JA MacDonald
+@author  Patrick Wells
+@date    18-Oct-2026 (created)
+
+usage: trace2chrome.py capture.log [-o trace.json] [--clock HZ]
+"""
+import argparse
+import json
+import re
+import struct
+import sys
+
+# Must match Trace.h
+APC = re.compile(rb"\x1b_T([0-9A-Fa-f]*)\x1b\\")
+RECORD = struct.Struct("<IBBH")
+EVENTS = ["switch", "send", "receive", "bind", "block", "isr entry", "isr exit"]
+SWITCH, SEND, RECEIVE, BIND, BLOCK, ISR_ENTRY, ISR_EXIT = range(len(EVENTS))
+BLOCK_STATES = ["ready", "recv", "wait", "suspended", "channel", "mutex", "semaphore"]
+ISRS = ["UART0", "UART1", "SYSTICK"]
+NO_PID = 0xFF
+ISR_TID = 1000
+
+
+def last_dump(capture):
+    """Returns the hex payloads of the last dump in the capture"""
+    records = []
+    for match in APC.finditer(capture):
+        payload = match.group(1)
+        if not payload:
+            records = []
+        else:
+            records.append(bytes.fromhex(payload.decode()))
+    return records
+
+
+def decode(records, clock):
+    """Unpacks the records and turns the wrapping cycle count into us"""
+    events = []
+    base = None
+    last = 0
+    offset = 0
+    for raw in records:
+        time, event, pid, arg = RECORD.unpack(raw)
+        if base is None:
+            base = time
+        time -= base
+        if time + offset < last:
+            offset += 1 << 32
+        last = time + offset
+        events.append((last * 1e6 / clock, event, pid, arg))
+    return events
+
+
+def name(table, index):
+    return table[index] if index < len(table) else str(index)
+
+
+def to_chrome(events):
+    """Builds running spans per process plus instant and ISR events"""
+    trace = []
+    running = None
+    since = events[0][0] if events else 0.0
+    for ts, event, pid, arg in events:
+        if event == SWITCH:
+            trace.append({"name": "run", "ph": "X", "pid": 0, "tid": arg,
+                          "ts": since, "dur": ts - since})
+            running, since = pid, ts
+        elif event in (ISR_ENTRY, ISR_EXIT):
+            trace.append({"name": name(ISRS, arg), "ph": "B" if event == ISR_ENTRY else "E",
+                          "pid": 0, "tid": ISR_TID, "ts": ts})
+        else:
+            label = name(EVENTS, event)
+            detail = name(BLOCK_STATES, arg) if event == BLOCK else "MB %d" % arg
+            trace.append({"name": "%s %s" % (label, detail), "ph": "i", "s": "t",
+                          "pid": 0, "tid": pid, "ts": ts})
+
+    if running is None and events and events[-1][2] != NO_PID:
+        running = events[-1][2]
+    if running is not None:
+        trace.append({"name": "run", "ph": "X", "pid": 0, "tid": running,
+                      "ts": since, "dur": events[-1][0] - since})
+
+    tids = {e["tid"] for e in trace}
+    for tid in tids:
+        label = "ISR" if tid == ISR_TID else "pid %d" % tid
+        trace.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": tid,
+                      "args": {"name": label}})
+    return {"traceEvents": trace, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[2].strip())
+    parser.add_argument("capture", help="raw UART0 capture holding a trace dump")
+    parser.add_argument("-o", "--output", help="JSON file written, stdout if omitted")
+    parser.add_argument("--clock", type=float, default=120e6,
+                        help="SysTick clock in Hz (default 120 MHz)")
+    args = parser.parse_args()
+
+    with open(args.capture, "rb") as capture:
+        records = last_dump(capture.read())
+    if not records:
+        sys.exit("no trace dump found in %s" % args.capture)
+
+    chrome = to_chrome(decode(records, args.clock))
+    if args.output:
+        with open(args.output, "w") as output:
+            json.dump(chrome, output)
+    else:
+        json.dump(chrome, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()